@@ -54,8 +54,14 @@ AbstractList::AbstractList(){
 }
 
 NodeInfo AbstractList::eval(ScopeManager &scope){
-    this->info.data = this;
-    return this->info;
+    CANVAS_STAT_NODE(this->info.type);
+    std::vector<Data> elements;
+    elements.reserve(m_childrens.size());
+    for(auto &e : m_childrens){
+        elements.emplace_back(identifierToLiteral(e->eval(scope), scope).data);
+    }
+
+    return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
 }
 
 /* BlockStatement Struct */
@@ -65,11 +71,15 @@ BlockStatement::BlockStatement(){
 }
 
 NodeInfo BlockStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     scope.pushScope();
     for(auto &e : m_childrens){
+        if(scope.profiler != nullptr){
+            scope.profiler->line(e->row);
+        }
         NodeInfo _info = e->eval(scope); 
 
-        if(scope.isReturning){
+        if(scope.completion != Completion::NORMAL){
             scope.popScope();
             return _info;
         }
@@ -86,10 +96,14 @@ PostBlockStatement::PostBlockStatement(){
 }
 
 NodeInfo PostBlockStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     for(auto &e : m_childrens){
+        if(scope.profiler != nullptr){
+            scope.profiler->line(e->row);
+        }
         NodeInfo _info = e->eval(scope);
 
-        if(_info.type == NodeType::BRK_STM || _info.type == NodeType::CON_STM || scope.isReturning){
+        if(scope.completion != Completion::NORMAL){
             return _info;
         }
     };
@@ -105,6 +119,7 @@ IfStatement::IfStatement(std::shared_ptr<AbstractNode> condition){
 }
 
 NodeInfo IfStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     if(!isVariantEmptyOrNull(identifierToLiteral(m_childrens[0]->eval(scope), scope).data)){
         return m_childrens[1]->eval(scope);
     }else{
@@ -133,24 +148,19 @@ WhileStatement::WhileStatement(std::shared_ptr<AbstractNode> condition){
 }
 
 NodeInfo WhileStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
+    NodeInfo _info = this->info;
     scope.pushScope();
     while(!isVariantEmptyOrNull(identifierToLiteral(m_childrens[0]->eval(scope), scope).data)){
-        NodeInfo _info = m_childrens[1]->eval(scope);
-        if(scope.isReturning){
-            scope.popScope();
-            return _info;
-        }
-
-        if(_info.type == NodeType::BRK_STM){
-            scope.popScope();
+        scope.step();
+        _info = m_childrens[1]->eval(scope);
+        if(scope.completion != Completion::NORMAL && scope.endsLoop()){
             break;
-        }else if(_info.type == NodeType::CON_STM){
-            continue;
         }
     }
     scope.popScope();
     
-    return this->info;
+    return scope.completion == Completion::RETURN ? _info : this->info;
 }
 
 /* ForStatement Struct */
@@ -160,32 +170,24 @@ ForStatement::ForStatement(){
 }
 
 NodeInfo ForStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(NodeType::FOR_STM);
+    NodeInfo _info = this->info;
     if(!m_childrens[0]->getChildrens().empty()){
         scope.pushScope();
-        NodeInfo firstStatement = m_childrens[0]->getChild(0)->eval(scope);
-        NodeInfo secondStatement = m_childrens[0]->getChild(1)->eval(scope);
-        NodeInfo thirdStatement;
-        while(!isVariantEmptyOrNull(identifierToLiteral(secondStatement, scope).data)){
-            NodeInfo _info = m_childrens[1]->eval(scope);
-            if(scope.isReturning){
-                scope.popScope();
-                return _info;
-            }
-
-            if(_info.type == NodeType::BRK_STM){
-                scope.popScope();
+        m_childrens[0]->getChild(0)->eval(scope);
+        while(!isVariantEmptyOrNull(identifierToLiteral(m_childrens[0]->getChild(1)->eval(scope), scope).data)){
+            scope.step();
+            _info = m_childrens[1]->eval(scope);
+            if(scope.completion != Completion::NORMAL && scope.endsLoop()){
                 break;
-            }else if(_info.type == NodeType::CON_STM){
-                continue;
             }
 
-            thirdStatement = m_childrens[0]->getChild(2)->eval(scope);
-            secondStatement = m_childrens[0]->getChild(1)->eval(scope);
+            m_childrens[0]->getChild(2)->eval(scope);
         }
         scope.popScope();
     }
     
-    return this->info;
+    return scope.completion == Completion::RETURN ? _info : this->info;
 }
 
 /* ForeachStatement Struct */
@@ -195,27 +197,26 @@ ForeachStatement::ForeachStatement(){
 }
 
 NodeInfo ForeachStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(NodeType::FOR_STM);
     if(Data *data = scope.findData(m_childrens[1]->getValue())){
-        if(std::holds_alternative<void*>(*data)){
-            AbstractList* listPtr = reinterpret_cast<AbstractList*>(std::get<void*>(*data));
+        if(std::holds_alternative<Ref>(*data) && std::get<Ref>(*data).get()->kind == HeapObjectType::LIST){
+            Ref listRef = std::get<Ref>(*data);
+            NodeInfo _info = this->info;
             scope.pushScope();
-            for(auto &e : listPtr->getChildrens()){
-                scope.pushData(m_childrens[0]->getValue(), e->eval(scope).data);
+            for(auto &e : listRef.as<ListObject>()->elements){
+                scope.step();
+                scope.pushData(m_childrens[0]->getValue(), e);
 
-                NodeInfo _info = m_childrens[2]->eval(scope);
-                if(scope.isReturning){
-                    scope.popScope();
-                    return _info;
-                }
-                
-                if(_info.type == NodeType::BRK_STM){
-                    scope.popScope();
+                _info = m_childrens[2]->eval(scope);
+                if(scope.completion != Completion::NORMAL && scope.endsLoop()){
                     break;
-                }else if(_info.type == NodeType::CON_STM){
-                    continue;
                 }
             }
             scope.popScope();
+
+            if(scope.completion == Completion::RETURN){
+                return _info;
+            }
         }
     }else{
         throw ParserException("~Error~ Undefined Identifier \'" + m_childrens[1]->getValue() + "\'.");
@@ -232,26 +233,24 @@ RepeatStatement::RepeatStatement(std::shared_ptr<AbstractNode> count){
 }
 
 NodeInfo RepeatStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     NodeInfo expression = identifierToLiteral(m_childrens[0]->eval(scope), scope);
     if(expression.type == NodeType::NUM_LIT && variantAsNum(expression.data) >= 0){
         scope.pushScope();
         unsigned int count = variantAsNum(expression.data);
         NodeInfo _info;
         for(unsigned int i = 0; i < count; ++i){
-            NodeInfo _info = m_childrens[1]->eval(scope);
-            if(scope.isReturning){
-                scope.popScope();
-                return _info;
-            }
-            
-            if(_info.type == NodeType::BRK_STM){
-                scope.popScope();
+            scope.step();
+            _info = m_childrens[1]->eval(scope);
+            if(scope.completion != Completion::NORMAL && scope.endsLoop()){
                 break;
-            }else if(_info.type == NodeType::CON_STM){
-                continue;
             }
         }
         scope.popScope();
+
+        if(scope.completion == Completion::RETURN){
+            return _info;
+        }
     }else{
         throw ParserException("~Error~ Invalid arguments for 'repeat'");
     }
@@ -270,6 +269,7 @@ BinaryExpression::BinaryExpression(std::string &oprStr, std::shared_ptr<Abstract
 }
 
 NodeInfo BinaryExpression::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     NodeInfo leftNode = identifierToLiteral(m_childrens[0]->eval(scope), scope);
     NodeInfo rightNode = identifierToLiteral(m_childrens[1]->eval(scope), scope);
 
@@ -384,12 +384,16 @@ NodeInfo BinaryExpression::eval(ScopeManager &scope){
                 int index = static_cast<int>(variantAsNum(rightNode.data));
                 switch (leftNode.type)
                 {
-                case NodeType::PTR:
-                case NodeType::ABS_LST:
+                case NodeType::OBJ:
                     {
-                        AbstractList* _data = static_cast<AbstractList*>(std::get<void*>(leftNode.data));
-                        if(index < _data->getChildrens().size() && index >= 0){
-                            leftNode = _data->getChildrens()[static_cast<int>(variantAsNum(rightNode.data))]->eval(scope);
+                        Ref listRef = std::get<Ref>(leftNode.data);
+                        if(listRef.get()->kind != HeapObjectType::LIST){
+                            throw ParserException("~Error~ Invalid Binary Operation \'" + variantAsStr(leftNode.data) + ' ' + m_value + ' ' + variantAsStr(rightNode.data) + "\' Incompatible Types.");
+                        }
+
+                        std::vector<Data> &elements = listRef.as<ListObject>()->elements;
+                        if(index >= 0 && static_cast<std::size_t>(index) < elements.size()){
+                            leftNode = dataToLiteral(elements[index]);
                         }else{
                             throw ParserException("~Error~ Out of bounds exception");
                         }
@@ -430,6 +434,7 @@ UnaryExpression::UnaryExpression(std::string &oprStr, std::shared_ptr<AbstractNo
 }
 
 NodeInfo UnaryExpression::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     NodeInfo leftNode = m_childrens[0]->eval(scope);
 
     std::string identifier;
@@ -502,6 +507,8 @@ Literal::Literal(Data &value){
 }
 
 NodeInfo Literal::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
+    CANVAS_STAT_STRING(this->info.data);
 
     return this->info;
 }
@@ -514,7 +521,9 @@ Identifier::Identifier(std::string &name){
 }
 
 NodeInfo Identifier::eval(ScopeManager &scope){
-    
+    CANVAS_STAT_NODE(this->info.type);
+    CANVAS_STAT_STRING(this->info.data);
+
     return this->info;
 }
 
@@ -526,6 +535,7 @@ DefStatement::DefStatement(){
 }
 
 NodeInfo DefStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     Data *data = scope.findData(std::get<std::string>(m_childrens[0]->eval(scope).data));
     if(data == nullptr){
         std::string identifier = std::get<std::string>(m_childrens[0]->eval(scope).data);
@@ -543,16 +553,73 @@ DefLambdaStatement::DefLambdaStatement(){
 }
 
 NodeInfo DefLambdaStatement::eval(ScopeManager &scope){
-    // scope.pushScope();
-    // NodeInfo _info = m_childrens[1]->eval(scope);
+    CANVAS_STAT_NODE(this->info.type);
+    std::vector<std::pair<std::string, Ref>> upvalues;
+    upvalues.reserve(captures.size());
+    for(auto &e : captures){
+        Ref upvalue = scope.captureUpvalue(e);
+        if(upvalue){
+            upvalues.emplace_back(e, std::move(upvalue));
+        }
+    }
+    for(auto &e : calleeCaptures){
+        Data *data = scope.findData(e);
+        if(data != nullptr && std::holds_alternative<Ref>(*data) && std::get<Ref>(*data) && std::get<Ref>(*data).get()->kind == HeapObjectType::CLOSURE){
+            upvalues.emplace_back(e, scope.captureUpvalue(e));
+        }
+    }
 
-    // if(scope.isReturning){
-    //     scope.popScope();
-    //     return _info;
-    // }
-    // scope.popScope();
+    return NodeInfo(NodeType::OBJ, scope.getHeap().make<ClosureObject>(this, std::move(upvalues), scope.getCurrentScope()));
+}
 
-    return this->info;
+// Collects every name the body refers to that isn't a parameter, these are captured as upvalues
+// when the lambda is evaluated. Parameters of nested lambdas are bound inside their bodies only.
+// Names that are only called are kept apart: builtins and named functions need no upvalue, so they
+// are captured only if they hold a closure when the lambda is evaluated. Runs once from the parser
+// so evaluation never mutates the tree.
+void DefLambdaStatement::collectCaptures(){
+    using Bound = std::unordered_set<std::string>;
+    std::shared_ptr<Bound> params = std::make_shared<Bound>();
+    for(auto &e : m_childrens[0]->getChildrens()){
+        params->insert(e->getValue());
+    }
+
+    std::unordered_set<std::string> seen, called;
+    std::vector<std::pair<AbstractNode*, std::shared_ptr<const Bound>>> stack = {{m_childrens[1].get(), params}};
+    while(!stack.empty()){
+        AbstractNode *node = stack.back().first;
+        std::shared_ptr<const Bound> bound = stack.back().second;
+        stack.pop_back();
+
+        if(node->info.type == NodeType::IDN){
+            const std::string &name = node->getValue();
+            if(bound->find(name) == bound->end() && seen.insert(name).second){
+                captures.emplace_back(name);
+            }
+        }else if(node->info.type == NodeType::CAL_STM){
+            const std::string &name = node->getChild(0)->getValue();
+            if(bound->find(name) == bound->end() && called.insert(name).second){
+                calleeCaptures.emplace_back(name);
+            }
+            stack.emplace_back(node->getChild(1).get(), bound);
+            continue;
+        }else if(node->info.type == NodeType::DEF_LAM_STM){
+            std::shared_ptr<Bound> nested = std::make_shared<Bound>(*bound);
+            for(auto &e : node->getChild(0)->getChildrens()){
+                nested->insert(e->getValue());
+            }
+            stack.emplace_back(node->getChild(1).get(), nested);
+            continue;
+        }
+
+        for(auto &e : node->getChildrens()){
+            stack.emplace_back(e.get(), bound);
+        }
+    }
+
+    calleeCaptures.erase(std::remove_if(calleeCaptures.begin(), calleeCaptures.end(), [&seen](const std::string &name){
+        return seen.find(name) != seen.end();
+    }), calleeCaptures.end());
 }
 
 /* RetStatement Struct */
@@ -563,8 +630,18 @@ RetStatement::RetStatement(std::shared_ptr<AbstractNode> expression){
 }
 
 NodeInfo RetStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
+    // A returned call to a user function is handed back to the enclosing callFunction, which reuses
+    // its frame for it instead of nesting another one.
+    if(!scope.callStack.empty() && m_childrens[0]->info.type == NodeType::CAL_STM){
+        if(static_cast<CallStatement*>(m_childrens[0].get())->prepareTailCall(scope)){
+            scope.completion = Completion::RETURN;
+            return NodeInfo();
+        }
+    }
+
     NodeInfo _info = identifierToLiteral(m_childrens[0]->eval(scope), scope); 
-    scope.isReturning = true;
+    scope.completion = Completion::RETURN;
     return _info;
 }
 
@@ -585,6 +662,8 @@ FlowPoint::FlowPoint(unsigned int flowType){
 }
 
 NodeInfo FlowPoint::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
+    scope.completion = this->info.type == NodeType::BRK_STM ? Completion::BREAK : Completion::CONTINUE;
 
     return this->info;
 }
@@ -598,6 +677,7 @@ CallStatement::CallStatement(std::string &name, std::shared_ptr<AbstractNode> ar
 }
 
 NodeInfo CallStatement::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     std::string identifier = std::get<std::string>(m_childrens[0]->eval(scope).data);
     std::vector<NodeInfo> argsList;
     argsList.reserve(m_childrens[1]->getChildrens().size());
@@ -607,183 +687,764 @@ NodeInfo CallStatement::eval(ScopeManager &scope){
     }
     
     if(Data *data = scope.findData(identifier)){
-        DefStatement *funDefPtr = reinterpret_cast<DefStatement*>(std::get<void*>(*data));
-        std::vector<std::string> paramsList;
-        paramsList.reserve(funDefPtr->getChild(1)->getChildrens().size());
-        for(auto &e : funDefPtr->getChild(1)->getChildrens()){
-            paramsList.emplace_back(std::get<std::string>(e->eval(scope).data));
+        return callFunction(scope, identifier, *data, argsList, 0);
+    }
+
+    if(scope.natives != nullptr){
+        if(const NativeFunction *native = scope.natives->find(identifier)){
+            return (*native)(scope, argsList);
         }
+    }
 
-        if(paramsList.size() == argsList.size()){
-            scope.pushScope();
-            for(int i = 0; i < paramsList.size(); i++){
-                scope.pushData(paramsList[i], argsList[i].data);
-            }
+    CANVAS_STAT_BUILTIN(identifier);
+    return evalBuiltin(scope, identifier, argsList);
+}
 
-            NodeInfo _info = funDefPtr->getChild(2)->eval(scope);
-            scope.isReturning = false;
-            scope.popScope();
-            return _info;
-        }else{
-            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
-        }
-    }else{
-        // Handling Predefined Functions.
-        if(identifier == "print"){
-            for (auto &e : argsList) {
-                std::string _str = sanitizeStr(variantAsStr(e.data));
-                for (size_t i = 0; i < _str.length(); ++i) {
-                    if(_str[i] == '\\' && i + 1 < _str.length()) {
-                        if (_str[i + 1] == 'n') {
+// Kept out of eval so the frames of nested user calls stay small.
+NodeInfo CallStatement::evalBuiltin(ScopeManager &scope, const std::string &identifier, std::vector<NodeInfo> &argsList){
+    // Handling Predefined Functions.
+    if(identifier == "print"){
+        for (auto &e : argsList) {
+            std::string _str = sanitizeStr(variantAsStr(e.data));
+            for (size_t i = 0; i < _str.length(); ++i) {
+                if(_str[i] == '\\' && i + 1 < _str.length()) {
+                    if (_str[i + 1] == 'n') {
+                        std::cout << '\n';
+                        ++i;
+                    } else if (_str[i + 1] == '\\') {
+                        std::cout << '\\';
+                        ++i;
+                    } else {
+                        std::cout << '\\' << _str[i + 1];
+                        ++i;
+                    }
+                }else{
+                    std::cout << _str[i];
+                }
+            }
+        } std::cout << std::endl;
+    }else if(identifier == "printf"){
+        if(!argsList.empty()){
+            std::string _formatStr = sanitizeStr(variantAsStr(argsList[0].data));
+
+            size_t argIndex = 1;
+            for(size_t i = 0; i < _formatStr.length(); ++i){
+                if(_formatStr[i] == '%' && i + 1 < _formatStr.length() && _formatStr[i + 1] == 's'){
+                    if(argIndex < argsList.size()){
+                        std::cout << sanitizeStr(variantAsStr(argsList[argIndex].data));
+                        ++argIndex;
+                    }else{
+                        std::cout << "%s";
+                    }
+                    ++i;
+                }else{
+                    if(_formatStr[i] == '\\' && i + 1 < _formatStr.length()) {
+                        if (_formatStr[i + 1] == 'n') {
                             std::cout << '\n';
                             ++i;
-                        } else if (_str[i + 1] == '\\') {
+                        } else if (_formatStr[i + 1] == '\\') {
                             std::cout << '\\';
                             ++i;
                         } else {
-                            std::cout << '\\' << _str[i + 1];
+                            std::cout << '\\' << _formatStr[i + 1];
                             ++i;
                         }
                     }else{
-                        std::cout << _str[i];
+                        std::cout << _formatStr[i];
                     }
                 }
-            } std::cout << std::endl;
-        }else if(identifier == "printf"){
-            if(!argsList.empty()){
-                std::string _formatStr = sanitizeStr(variantAsStr(argsList[0].data));
-
-                size_t argIndex = 1;
-                for(size_t i = 0; i < _formatStr.length(); ++i){
-                    if(_formatStr[i] == '%' && i + 1 < _formatStr.length() && _formatStr[i + 1] == 's'){
-                        if(argIndex < argsList.size()){
-                            std::cout << sanitizeStr(variantAsStr(argsList[argIndex].data));
-                            ++argIndex;
-                        }else{
-                            std::cout << "%s";
-                        }
-                        ++i;
-                    }else{
-                        if(_formatStr[i] == '\\' && i + 1 < _formatStr.length()) {
-                            if (_formatStr[i + 1] == 'n') {
-                                std::cout << '\n';
-                                ++i;
-                            } else if (_formatStr[i + 1] == '\\') {
-                                std::cout << '\\';
-                                ++i;
-                            } else {
-                                std::cout << '\\' << _formatStr[i + 1];
-                                ++i;
-                            }
-                        }else{
-                            std::cout << _formatStr[i];
-                        }
-                    }
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "canvas"){
+        if(argsList.size() == 2 || argsList.size() == 3){
+            int width = toCoordinate(argsList[0].data);
+            int height = toCoordinate(argsList[1].data);
+            if(width <= 0 || height <= 0 || width > 65535 || height > 65535){
+                throw ParserException("~Error~ Invalid canvas size " + std::to_string(width) + "x" + std::to_string(height) + ".");
+            }
+
+            std::uint32_t background = argsList.size() == 3 ? parseColor(argsList[2].data) : 0;
+            scope.getHeap().reserve(CanvasObject::byteSizeFor(width, height));
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<CanvasObject>(width, height, background));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "pixel"){
+        if(argsList.size() == 4){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            canvas->record(DrawCommand{DrawCommandType::PIXEL, toCoordinate(argsList[1].data), toCoordinate(argsList[2].data), 0, 0, parseColor(argsList[3].data)});
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "line"){
+        if(argsList.size() == 6){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            canvas->record(DrawCommand{DrawCommandType::LINE, toCoordinate(argsList[1].data), toCoordinate(argsList[2].data), toCoordinate(argsList[3].data), toCoordinate(argsList[4].data), parseColor(argsList[5].data)});
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "clear"){
+        if(argsList.size() == 2){
+            asCanvas(argsList[0].data, identifier)->record(DrawCommand{DrawCommandType::CLEAR, 0, 0, 0, 0, parseColor(argsList[1].data)});
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "blit"){
+        if(argsList.size() == 4 || argsList.size() == 5){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            CanvasObject *source = asCanvas(argsList[1].data, identifier);
+            bool isBlending = argsList.size() == 4 || !isVariantEmptyOrNull(argsList[4].data);
+            canvas->drawImage(*source, source->bounds(), toCoordinate(argsList[2].data), toCoordinate(argsList[3].data), isBlending);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "batch_begin"){
+        if(argsList.size() == 1){
+            asCanvas(argsList[0].data, identifier)->isBatching = true;
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "batch_end"){
+        if(argsList.size() == 1){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            // A batch inside a frame leaves the commands to the frame.
+            if(canvas->isFraming){
+                return NodeInfo(NodeType::NUM_LIT, static_cast<float>(canvas->pending.size()));
+            }
+
+            canvas->isBatching = false;
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(canvas->flush()));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "frame_begin"){
+        if(argsList.size() == 1){
+            asCanvas(argsList[0].data, identifier)->beginFrame();
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "frame_end"){
+        // Returns the number of pixels in the tiles that changed since the previous frame.
+        if(argsList.size() == 1){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            const FrameStats &stats = canvas->endFrame();
+            if(scope.isolate == nullptr && frameSink().isOpen()){
+                frameSink().submit(*canvas);
+            }
+
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(stats.dirtyPixels));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "frames_open"){
+        // params: <"out/frame_%04d.png" or "out.y4m">, <fps[optional, default 30]>
+        // Every frame_end() afterwards queues the canvas to be written.
+        if(scope.isolate != nullptr){
+            throw ParserException("~Error~ '" + identifier + "' is only available to the main script.");
+        }else if((argsList.size() == 1 || argsList.size() == 2) && argsList[0].type == NodeType::STR_LIT){
+            std::string target = stripStr(variantAsStr(argsList[0].data));
+            if(target == "-"){
+                throw ParserException("~Error~ Streaming frames to stdout needs \'--frames -\'.");
+            }
+
+            frameSink().open(target, argsList.size() == 2 ? static_cast<int>(variantAsNum(argsList[1].data)) : 30);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "frames_close"){
+        // Waits for the queued frames, returns the number of frames written.
+        if(scope.isolate != nullptr){
+            throw ParserException("~Error~ '" + identifier + "' is only available to the main script.");
+        }else if(argsList.empty()){
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(frameSink().close()));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "frame_stats"){
+        // [frames, dirty pixels, dirty tiles, redrawn tiles, skipped tiles, milliseconds] of the last frame.
+        // Tiles drawn early because the frame read its own pixels are dirty but neither redrawn nor skipped.
+        if(argsList.size() == 1){
+            const FrameStats &stats = asCanvas(argsList[0].data, identifier)->frameStats;
+            std::vector<Data> values = {static_cast<float>(stats.frames), static_cast<float>(stats.dirtyPixels), static_cast<float>(stats.dirtyTiles), static_cast<float>(stats.redrawnTiles), static_cast<float>(stats.skippedTiles), static_cast<float>(stats.milliseconds)};
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(values)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "pixels" || identifier == "lines" || identifier == "rects" || identifier == "fill_rects"){
+        // Array variants, one call submits every primitive in a flat list of coordinates.
+        if(argsList.size() == 3 && argsList[1].type == NodeType::OBJ && std::get<Ref>(argsList[1].data).get()->kind == HeapObjectType::LIST){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            std::vector<Data> &coordinates = std::get<Ref>(argsList[1].data).as<ListObject>()->elements;
+            DrawCommandType type = identifier == "pixels" ? DrawCommandType::PIXEL : identifier == "lines" ? DrawCommandType::LINE : identifier == "rects" ? DrawCommandType::RECT : DrawCommandType::FILL_RECT;
+            std::size_t arity = type == DrawCommandType::PIXEL ? 2 : 4;
+            if(coordinates.size() % arity != 0){
+                throw ParserException("~Error~ \'" + identifier + "\' expects groups of " + std::to_string(arity) + " coordinates.");
+            }
+
+            std::uint32_t color = parseColor(argsList[2].data);
+            canvas->pending.reserve(canvas->pending.size() + coordinates.size() / arity);
+            for(std::size_t i = 0; i < coordinates.size(); i += arity){
+                DrawCommand command = {type, toCoordinate(coordinates[i]), toCoordinate(coordinates[i + 1]), 0, 0, color};
+                if(arity == 4){
+                    command.x1 = toCoordinate(coordinates[i + 2]);
+                    command.y1 = toCoordinate(coordinates[i + 3]);
                 }
+                canvas->record(command);
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "get_pixel"){
+        if(argsList.size() == 3){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            int x = toCoordinate(argsList[1].data);
+            int y = toCoordinate(argsList[2].data);
+            if(x < 0 || y < 0 || x >= canvas->width || y >= canvas->height){
+                throw ParserException("~Error~ Pixel (" + std::to_string(x) + ", " + std::to_string(y) + ") is outside the canvas.");
+            }
+
+            // Inside a frame this draws what was recorded so far, the tiles it touches are redrawn.
+            canvas->flush();
+            std::uint32_t color = canvas->row(y)[x];
+            std::vector<Data> channels;
+            for(int shift = 0; shift < 32; shift += 8){
+                channels.emplace_back(static_cast<float>((color >> shift) & 0xFF));
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(channels)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "rect" || identifier == "fill_rect"){
+        if(argsList.size() == 6){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            int x = toCoordinate(argsList[1].data);
+            int y = toCoordinate(argsList[2].data);
+            int w = toCoordinate(argsList[3].data);
+            int h = toCoordinate(argsList[4].data);
+            std::uint32_t color = parseColor(argsList[5].data);
+            canvas->record(DrawCommand{identifier == "rect" ? DrawCommandType::RECT : DrawCommandType::FILL_RECT, x, y, w, h, color});
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "save"){
+        // params: <canvas>, <path>, <format[optional, from the extension]>
+        if(argsList.size() == 2 || argsList.size() == 3){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            std::string path = stripStr(variantAsStr(argsList[1].data));
+            std::string format = argsList.size() == 3 ? stripStr(variantAsStr(argsList[2].data)) : "";
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(saveImage(*canvas, path, parseImageFormat(path, format))));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "load_image"){
+        if(argsList.size() == 1){
+            return NodeInfo(NodeType::OBJ, scope.getHeap().manage(loadImage(stripStr(variantAsStr(argsList[0].data)), &scope.getHeap()).release()));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "cache_assets"){
+        // params: <cache_path>, <image_paths[list]>
+        if(argsList.size() == 2 && argsList[1].type == NodeType::OBJ && std::get<Ref>(argsList[1].data).get()->kind == HeapObjectType::LIST){
+            std::vector<std::string> paths;
+            for(auto &e : std::get<Ref>(argsList[1].data).as<ListObject>()->elements){
+                paths.emplace_back(stripStr(variantAsStr(e)));
+            }
+
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(writeAssetCache(stripStr(variantAsStr(argsList[0].data)), paths)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "sprite"){
+        if(argsList.size() == 1 || argsList.size() == 5){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            ClipRect region = canvas->bounds();
+            if(argsList.size() == 5){
+                int x = toCoordinate(argsList[1].data);
+                int y = toCoordinate(argsList[2].data);
+                region = ClipRect{x, y, x + toCoordinate(argsList[3].data), y + toCoordinate(argsList[4].data)};
+                if(x < 0 || y < 0 || region.x1 <= x || region.y1 <= y || region.x1 > canvas->width || region.y1 > canvas->height){
+                    throw ParserException("~Error~ Sprite region is outside the canvas.");
+                }
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<SpriteObject>(std::get<Ref>(argsList[0].data), region));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "draw_sprite"){
+        // params: <canvas>, <sprite>, <x>, <y>, <blend[optional, default 1]>
+        if(argsList.size() == 4 || argsList.size() == 5){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            SpriteObject *sprite = asSprite(argsList[1].data, identifier);
+            bool isBlending = argsList.size() == 4 || !isVariantEmptyOrNull(argsList[4].data);
+            canvas->drawImage(sprite->canvas(), sprite->region, toCoordinate(argsList[2].data), toCoordinate(argsList[3].data), isBlending);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "atlas"){
+        // Packs canvases and sprites into one canvas and returns a sprite of it for each, in order.
+        if(argsList.size() == 1 && argsList[0].type == NodeType::OBJ && std::get<Ref>(argsList[0].data).get()->kind == HeapObjectType::LIST){
+            std::vector<Data> &images = std::get<Ref>(argsList[0].data).as<ListObject>()->elements;
+            std::vector<std::pair<CanvasObject*, ClipRect>> sources;
+            std::vector<std::pair<int, int>> sizes;
+            for(auto &e : images){
+                const Ref *refPtr = std::get_if<Ref>(&e);
+                if(refPtr && *refPtr && refPtr->get()->kind == HeapObjectType::SPRITE){
+                    SpriteObject *sprite = refPtr->as<SpriteObject>();
+                    sources.emplace_back(&sprite->canvas(), sprite->region);
+                }else{
+                    CanvasObject *canvas = asCanvas(e, identifier);
+                    sources.emplace_back(canvas, canvas->bounds());
+                }
+                sources.back().first->flush();
+                sizes.emplace_back(sources.back().second.x1 - sources.back().second.x0, sources.back().second.y1 - sources.back().second.y0);
+            }
+
+            int atlasWidth, atlasHeight;
+            std::vector<AtlasPlacement> placements = packAtlas(sizes, atlasWidth, atlasHeight);
+            scope.getHeap().reserve(CanvasObject::byteSizeFor(atlasWidth, atlasHeight) + ListObject::byteSizeFor(sources.size()));
+            Ref atlas = scope.getHeap().make<CanvasObject>(atlasWidth, atlasHeight);
+            CanvasObject *atlasCanvas = atlas.as<CanvasObject>();
+
+            std::vector<Data> sprites;
+            sprites.reserve(sources.size());
+            for(std::size_t i = 0; i < sources.size(); ++i){
+                atlasCanvas->drawImage(*sources[i].first, sources[i].second, placements[i].x, placements[i].y, false);
+                ClipRect region = {placements[i].x, placements[i].y, placements[i].x + sizes[i].first, placements[i].y + sizes[i].second};
+                sprites.emplace_back(scope.getHeap().make<SpriteObject>(atlas, region));
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(sprites)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "image_size"){
+        if(argsList.size() == 1){
+            const Ref *refPtr = std::get_if<Ref>(&argsList[0].data);
+            std::vector<Data> size;
+            if(refPtr && *refPtr && refPtr->get()->kind == HeapObjectType::SPRITE){
+                size = {static_cast<float>(refPtr->as<SpriteObject>()->width()), static_cast<float>(refPtr->as<SpriteObject>()->height())};
             }else{
-                throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+                CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+                size = {static_cast<float>(canvas->width), static_cast<float>(canvas->height)};
             }
-        }else if(identifier == "input"){
-            for(auto &e : argsList){
-                std::string toBePrinted = variantAsStr(e.data);
-                std::cout << sanitizeStr(toBePrinted);
-            }
-            std::string inputStr;
-            std::getline(std::cin, inputStr);
-
-            return NodeInfo(NodeType::STR_LIT, '\"' + inputStr + '\"');
-        }else if(identifier == "to_num"){
-            if(argsList.size() == 1){
-                if(argsList[0].type == NodeType::NUM_LIT){
-                    return argsList[0];
-                }else if(argsList[0].type == NodeType::STR_LIT){
-                    std::string _strContent = stripStr(std::get<std::string>(argsList[0].data));
-                    if(g_util::isNumLiteral(_strContent)){
-                        return NodeInfo(NodeType::NUM_LIT, std::stof(_strContent));
-                    }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(size)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "gradient"){
+        if(argsList.size() == 7 || argsList.size() == 8){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            int x = toCoordinate(argsList[1].data);
+            int y = toCoordinate(argsList[2].data);
+            int w = toCoordinate(argsList[3].data);
+            int h = toCoordinate(argsList[4].data);
+            std::uint32_t from = parseColor(argsList[5].data);
+            std::uint32_t to = parseColor(argsList[6].data);
+            bool isVertical = argsList.size() == 8 && !isVariantEmptyOrNull(argsList[7].data);
+            canvas->drawGradient(x, y, w, h, from, to, isVertical);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "circle"){
+        // params: <canvas>, <cx>, <cy>, <radius>, <color>, <stroke width[optional, fills if omitted]>
+        if(argsList.size() == 5 || argsList.size() == 6){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            float cx = variantAsNum(argsList[1].data);
+            float cy = variantAsNum(argsList[2].data);
+            float radius = variantAsNum(argsList[3].data);
+            std::uint32_t color = parseColor(argsList[4].data);
+
+            std::vector<Contour> contours;
+            if(argsList.size() == 6){
+                float half = variantAsNum(argsList[5].data) * 0.5f;
+                contours.push_back(circleContour(cx, cy, radius + half));
+                if(radius - half > 0.0f){
+                    contours.push_back(circleContour(cx, cy, radius - half, true));
                 }
             }else{
-                throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+                contours.push_back(circleContour(cx, cy, radius));
+            }
+
+            canvas->drawShape(std::move(contours), color);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "polygon" || identifier == "path"){
+        // polygon: <canvas>, [x, y, ...], <color>, filled with the non-zero rule.
+        // path: <canvas>, [x, y, ...], <width>, <color>, <closed[optional, default 0]>, stroked.
+        bool isPath = identifier == "path";
+        bool isValid = isPath ? argsList.size() == 4 || argsList.size() == 5 : argsList.size() == 3;
+        if(isValid && argsList[1].type == NodeType::OBJ && std::get<Ref>(argsList[1].data).get()->kind == HeapObjectType::LIST){
+            CanvasObject *canvas = asCanvas(argsList[0].data, identifier);
+            std::vector<Data> &values = std::get<Ref>(argsList[1].data).as<ListObject>()->elements;
+            if(values.size() % 2 != 0){
+                throw ParserException("~Error~ \'" + identifier + "\' expects pairs of coordinates.");
+            }
+
+            std::vector<float> coordinates;
+            coordinates.reserve(values.size());
+            for(auto &e : values){
+                coordinates.push_back(variantAsNum(e));
             }
-        }else if(identifier == "to_str"){
-            if(argsList.size() == 1){
-                if(argsList[0].type == NodeType::STR_LIT){
-                    return argsList[0];
-                }else if(argsList[0].type == NodeType::NUM_LIT){
-                    return NodeInfo(NodeType::STR_LIT, '\"' + variantAsStr(argsList[0].data) + '\"');
+
+            std::vector<Contour> contours;
+            std::uint32_t color;
+            if(isPath){
+                bool isClosed = argsList.size() == 5 && !isVariantEmptyOrNull(argsList[4].data);
+                contours = strokeContours(coordinates, variantAsNum(argsList[2].data), isClosed);
+                color = parseColor(argsList[3].data);
+            }else{
+                contours.push_back(polygonContour(coordinates));
+                color = parseColor(argsList[2].data);
+            }
+
+            canvas->drawShape(std::move(contours), color);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "rgb" || identifier == "rgba"){
+        // Channels are 0-255, alpha is 0-1 like in hsla.
+        if(argsList.size() == (identifier == "rgb" ? 3u : 4u)){
+            std::uint8_t channels[4] = {0, 0, 0, 255};
+            for(std::size_t i = 0; i < 3; ++i){
+                channels[i] = toChannel(variantAsNum(argsList[i].data));
+            }
+            if(argsList.size() == 4){
+                channels[3] = toAlphaChannel(variantAsNum(argsList[3].data));
+            }
+
+            return NodeInfo(NodeType::NUM_LIT, colorToData(packColor(channels[0], channels[1], channels[2], channels[3])));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "hsl" || identifier == "hsla"){
+        if(argsList.size() == (identifier == "hsl" ? 3u : 4u)){
+            float alpha = argsList.size() == 4 ? variantAsNum(argsList[3].data) : 1.0f;
+            return NodeInfo(NodeType::NUM_LIT, colorToData(hslToColor(variantAsNum(argsList[0].data), variantAsNum(argsList[1].data), variantAsNum(argsList[2].data), alpha)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "hex"){
+        if(argsList.size() == 1 && argsList[0].type == NodeType::STR_LIT){
+            return NodeInfo(NodeType::NUM_LIT, colorToData(parseColor(argsList[0].data)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "to_hex"){
+        if(argsList.size() == 1){
+            return NodeInfo(NodeType::STR_LIT, '\"' + colorToHex(parseColor(argsList[0].data)) + '\"');
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "to_rgba" || identifier == "to_hsl"){
+        if(argsList.size() == 1){
+            std::uint32_t color = parseColor(argsList[0].data);
+            std::vector<Data> components;
+            if(identifier == "to_rgba"){
+                for(int channel = 0; channel < 4; ++channel){
+                    components.emplace_back(static_cast<float>(colorChannel(color, channel)));
                 }
             }else{
-                throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+                float h, s, l;
+                colorToHsl(color, h, s, l);
+                components = {h, s, l, colorAlpha(color) / 255.0f};
             }
-        }else if(identifier == "error"){
-            if(argsList.size() == 1){
-                throw Error(variantAsStr(argsList[0].data));
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(components)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "hsl_colors" || identifier == "rgb_colors"){
+        // Batch conversion of a flat [h, s, l, ...] or [r, g, b, ...] list into colour values.
+        if((argsList.size() == 1 || argsList.size() == 2) && argsList[0].type == NodeType::OBJ && std::get<Ref>(argsList[0].data).get()->kind == HeapObjectType::LIST){
+            std::vector<Data> &values = std::get<Ref>(argsList[0].data).as<ListObject>()->elements;
+            if(values.size() % 3 != 0){
+                throw ParserException("~Error~ \'" + identifier + "\' expects groups of 3 components.");
+            }
+
+            std::size_t count = values.size() / 3;
+            float alpha = argsList.size() == 2 ? variantAsNum(argsList[1].data) : 1.0f;
+            std::vector<std::uint32_t> colors(count);
+            if(identifier == "hsl_colors"){
+                std::vector<float> h(count), s(count), l(count), a(count, alpha);
+                for(std::size_t i = 0; i < count; ++i){
+                    h[i] = variantAsNum(values[i * 3]);
+                    s[i] = variantAsNum(values[i * 3 + 1]);
+                    l[i] = variantAsNum(values[i * 3 + 2]);
+                }
+                hslToColors(h.data(), s.data(), l.data(), a.data(), colors.data(), count);
             }else{
-                throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+                std::uint8_t a = toAlphaChannel(alpha);
+                for(std::size_t i = 0; i < count; ++i){
+                    std::uint8_t channels[3];
+                    for(std::size_t j = 0; j < 3; ++j){
+                        channels[j] = toChannel(variantAsNum(values[i * 3 + j]));
+                    }
+                    colors[i] = packColor(channels[0], channels[1], channels[2], a);
+                }
             }
-        }else if(identifier == "import"){
-            if(argsList.size() == 2){
-                if(argsList[0].type == NodeType::STR_LIT && argsList[1].type == NodeType::STR_LIT){
-                    if(stripStr(std::get<std::string>(argsList[0].data)) == "LIB"){
-                        std::string importName = stripStr(std::get<std::string>(argsList[1].data));
-                        if(const std::shared_ptr<AbstractNode> libNode = scope.findLib(importName)){
-                            libNode->eval(scope);
-                            return NodeInfo(NodeType::LIB, libNode.get());
-                        }else{
-                            for(auto &e : scope.globalImportStack){
-                                if(importName == e){
-                                    throw ParserException("~Error~ Recursive imports \'" + importName + "\'.");
-                                }
+
+            std::vector<Data> elements;
+            elements.reserve(count);
+            for(std::uint32_t color : colors){
+                elements.emplace_back(colorToData(color));
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "gradient_colors"){
+        if(argsList.size() == 3){
+            int count = toCoordinate(argsList[2].data);
+            if(count < 0){
+                throw ParserException("~Error~ \'" + identifier + "\' expects a non negative count.");
+            }
+
+            scope.getHeap().reserve(ListObject::byteSizeFor(count));
+            std::vector<std::uint32_t> colors(count);
+            gradientColors(parseColor(argsList[0].data), parseColor(argsList[1].data), colors.data(), colors.size());
+
+            std::vector<Data> elements;
+            elements.reserve(colors.size());
+            for(std::uint32_t color : colors){
+                elements.emplace_back(colorToData(color));
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "input"){
+        for(auto &e : argsList){
+            std::string toBePrinted = variantAsStr(e.data);
+            std::cout << sanitizeStr(toBePrinted);
+        }
+        std::string inputStr;
+        std::getline(std::cin, inputStr);
+
+        return NodeInfo(NodeType::STR_LIT, '\"' + inputStr + '\"');
+    }else if(identifier == "to_num"){
+        if(argsList.size() == 1){
+            if(argsList[0].type == NodeType::NUM_LIT){
+                return argsList[0];
+            }else if(argsList[0].type == NodeType::STR_LIT){
+                std::string _strContent = stripStr(std::get<std::string>(argsList[0].data));
+                if(g_util::isNumLiteral(_strContent)){
+                    return NodeInfo(NodeType::NUM_LIT, std::stof(_strContent));
+                }
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "to_str"){
+        if(argsList.size() == 1){
+            if(argsList[0].type == NodeType::STR_LIT){
+                return argsList[0];
+            }else if(argsList[0].type == NodeType::NUM_LIT){
+                return NodeInfo(NodeType::STR_LIT, '\"' + variantAsStr(argsList[0].data) + '\"');
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "error"){
+        if(argsList.size() == 1){
+            throw Error(variantAsStr(argsList[0].data));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "import"){
+        if(argsList.size() == 2){
+            if(argsList[0].type == NodeType::STR_LIT && argsList[1].type == NodeType::STR_LIT){
+                if(stripStr(std::get<std::string>(argsList[0].data)) == "LIB"){
+                    std::string importName = stripStr(std::get<std::string>(argsList[1].data));
+                    if(const std::shared_ptr<AbstractNode> libNode = scope.findLib(importName)){
+                        libNode->eval(scope);
+                        return NodeInfo(NodeType::LIB, libNode.get());
+                    }else{
+                        for(auto &e : scope.globalImportStack){
+                            if(importName == e){
+                                throw ParserException("~Error~ Recursive imports \'" + importName + "\'.");
                             }
-                            scope.globalImportStack.emplace_back(importName);
-
-                            Interpreter libInterpreter;
-                            std::string code = loadFileContentAsCode(importName);
-                            libInterpreter.execute(code, scope, DebugType::NONE);
-                            std::shared_ptr<AbstractNode> treeRoot = libInterpreter.getExecutedRoot();
-                            scope.pushLib(importName, treeRoot);
-                            scope.globalImportStack.pop_back();
-                            return NodeInfo(NodeType::LIB, libNode.get());
                         }
-                    }else{
-                        throw ParserException("~Error~ Invalid import type for \'" + stripStr(std::get<std::string>(argsList[1].data)) + "\'.");
+                        scope.globalImportStack.emplace_back(importName);
+
+                        TraceSpan span("import " + importName, "import");
+                        Interpreter libInterpreter;
+                        std::string code = loadFileContentAsCode(importName);
+                        libInterpreter.execute(code, scope, DebugType::NONE);
+                        std::shared_ptr<AbstractNode> treeRoot = libInterpreter.getExecutedRoot();
+                        scope.pushLib(importName, treeRoot);
+                        scope.globalImportStack.pop_back();
+                        return NodeInfo(NodeType::LIB, libNode.get());
                     }
                 }else{
-                    throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+                    throw ParserException("~Error~ Invalid import type for \'" + stripStr(std::get<std::string>(argsList[1].data)) + "\'.");
                 }
             }else{
                 throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
             }
-        }else if(identifier == "invoke"){
-            if(argsList.size() >= 1){
-                if(argsList[0].type == NodeType::STR_LIT){
-                    return invoke(scope, stripStr(std::get<std::string>(argsList[0].data)), argsList);
-                }else if(argsList[0].type == NodeType::PTR){
-                    AbstractNode* ptr = reinterpret_cast<AbstractNode*>(std::get<void*>(argsList[0].data));
-                    if(ptr->info.type == NodeType::DEF_STM){
-                        return invoke(scope, ptr, argsList);
-                    }else if(ptr->info.type == NodeType::DEF_LAM_STM){
-                        AbstractNode* ptr = reinterpret_cast<AbstractNode*>(std::get<void*>(argsList[0].data));
-                        return invokeLambda(scope, ptr, argsList);
-                    }
-                }else if(argsList[0].type == NodeType::DEF_LAM_STM){
-                    AbstractNode* ptr = reinterpret_cast<AbstractNode*>(std::get<void*>(argsList[0].data));
-
-                    return invokeLambda(scope, ptr, argsList);;
-                }else{
-                    throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "trace_begin"){
+        if(argsList.size() == 1 && argsList[0].type == NodeType::STR_LIT){
+            if(tracer().isEnabled()){
+                tracer().beginScript(stripStr(std::get<std::string>(argsList[0].data)));
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "trace_end"){
+        if(argsList.empty()){
+            if(tracer().isEnabled() && !tracer().endScript()){
+                throw ParserException("~Error~ trace_end() without an open trace_begin().");
+            }
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "invoke"){
+        if(argsList.size() >= 1){
+            if(argsList[0].type == NodeType::STR_LIT){
+                return invoke(scope, stripStr(std::get<std::string>(argsList[0].data)), argsList);
+            }else if(argsList[0].type == NodeType::PTR){
+                AbstractNode* ptr = reinterpret_cast<AbstractNode*>(std::get<void*>(argsList[0].data));
+                if(ptr->info.type == NodeType::DEF_STM){
+                    return invoke(scope, ptr, argsList);
                 }
+            }else if(argsList[0].type == NodeType::OBJ){
+                return callFunction(scope, "lambda", argsList[0].data, argsList, 1);
             }else{
                 throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
             }
         }else{
-            throw ParserException("~Error~ Undefined Function Identifier \'" + identifier + "\'.");
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "gc_stats"){
+        if(argsList.empty()){
+            const HeapStats &stats = scope.getHeap().getStats();
+            std::vector<Data> elements = {
+                static_cast<float>(stats.liveObjects),
+                static_cast<float>(stats.liveBytes),
+                static_cast<float>(stats.peakBytes),
+                static_cast<float>(stats.totalAllocations),
+                static_cast<float>(stats.totalFrees),
+                static_cast<float>(stats.collections),
+                static_cast<float>(stats.cyclesFreed),
+                static_cast<float>(scope.getHeap().getLimit())
+            };
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "mem_usage"){
+        MemoryUsage usage;
+        if(argsList.empty()){
+            usage = totalMemoryUsage();
+        }else if(argsList.size() == 1 && argsList[0].type == NodeType::STR_LIT){
+            std::string name = stripStr(std::get<std::string>(argsList[0].data));
+            std::size_t category = 0;
+            while(category < static_cast<std::size_t>(MemoryCategory::COUNT) && name != memoryCategoryName(static_cast<MemoryCategory>(category))){
+                ++category;
+            }
+            if(category == static_cast<std::size_t>(MemoryCategory::COUNT)){
+                throw ParserException("~Error~ Unknown memory category \'" + name + "\'.");
+            }
+            usage = memoryUsage(static_cast<MemoryCategory>(category));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+
+        std::vector<Data> elements = {
+            static_cast<float>(usage.current),
+            static_cast<float>(usage.peak),
+            static_cast<float>(usage.allocations)
+        };
+        return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
+    }else if(identifier == "snapshot"){
+        if(argsList.size() == 1 && argsList[0].type == NodeType::STR_LIT){
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(writeSnapshot(stripStr(std::get<std::string>(argsList[0].data)), scope)));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "gc"){
+        if(argsList.empty()){
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(scope.getHeap().collect()));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
         }
+    }else if(identifier == "spawn"){
+        if(argsList.size() == 1 && argsList[0].type == NodeType::STR_LIT){
+            return NodeInfo(NodeType::NUM_LIT, static_cast<float>(spawnIsolate(scope, stripStr(std::get<std::string>(argsList[0].data)))));
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else if(identifier == "send"){
+        Message message;
+        MessageQueue &queue = findSendQueue(scope, argsList, identifier);
+        serializeValue(argsList.back().data, message);
+        queue.push(std::move(message));
+    }else if(identifier == "transfer"){
+        Message message;
+        MessageQueue &queue = findSendQueue(scope, argsList, identifier);
+        std::shared_ptr<AbstractNode> valueNode = m_childrens[1]->getChildrens().back();
+        Data *binding = valueNode->info.type == NodeType::IDN ? scope.findData(valueNode->getValue()) : nullptr;
+        transferValue(argsList.back(), binding, message);
+        queue.push(std::move(message));
+    }else if(identifier == "recv"){
+        Message message;
+        if(!findReceiveQueue(scope, argsList, identifier).pop(message)){
+            throw Error("~Error~ Isolate channel closed.");
+        }
+
+        std::size_t offset = 0;
+        return deserializeValue(message, offset, scope);
+    }else if(identifier == "join"){
+        if(argsList.size() == 1){
+            Isolate *isolate = findIsolate(scope, argsList[0]);
+            isolate->inbox.close();
+            return NodeInfo(NodeType::NUM_LIT, isolate->join() == RET_CODE::OK);
+        }else{
+            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+        }
+    }else{
+        throw ParserException("~Error~ Undefined Function Identifier \'" + identifier + "\'.");
     }
 
     return this->info;
 }
 
+bool CallStatement::prepareTailCall(ScopeManager &scope){
+    std::string identifier = std::get<std::string>(m_childrens[0]->eval(scope).data);
+    if(scope.findData(identifier) == nullptr){
+        return false;
+    }
+
+    std::vector<Data> args;
+    args.reserve(m_childrens[1]->getChildrens().size());
+    for(auto &e : m_childrens[1]->getChildrens()){
+        args.emplace_back(identifierToLiteral(e->eval(scope), scope).data);
+    }
+
+    Data *data = scope.findData(identifier);
+    if(data == nullptr){
+        throw ParserException("~Error~ Undefined Function Identifier \'" + identifier + "\'.");
+    }
+
+    scope.tailCall.name = identifier;
+    scope.tailCall.callee = *data;
+    scope.tailCall.args = std::move(args);
+    scope.tailCall.scope = scope.getCurrentScope();
+    scope.isTailCalling = true;
+
+    return true;
+}
+
 /* AssignementStatment Struct */
 AssignementStatment::AssignementStatment(std::string &oprStr, std::string &identifier, std::shared_ptr<AbstractNode> expression){
     this->info.type = NodeType::ASG_STM;
@@ -794,6 +1455,7 @@ AssignementStatment::AssignementStatment(std::string &oprStr, std::string &ident
 }
 
 NodeInfo AssignementStatment::eval(ScopeManager &scope){
+    CANVAS_STAT_NODE(this->info.type);
     std::string identifier = std::get<std::string>(m_childrens[0]->eval(scope).data);
     NodeInfo expression = identifierToLiteral(m_childrens[1]->eval(scope), scope);
 
@@ -808,6 +1470,7 @@ NodeInfo AssignementStatment::eval(ScopeManager &scope){
     }else{
         switch (this->type){
         case OperatorType::ASG_EQL:
+            CANVAS_STAT_STRING(expression.data);
             *data = expression.data;
             break;
         case OperatorType::ASG_ADD:
@@ -864,6 +1527,23 @@ NodeInfo AssignementStatment::eval(ScopeManager &scope){
 }
 
 // Helper Functions
+NodeInfo dataToLiteral(const Data &data){
+    CANVAS_STAT_STRING(data);
+    if(std::holds_alternative<void*>(data)){
+        return NodeInfo(NodeType::PTR, data);
+    }
+
+    if(std::holds_alternative<Ref>(data)){
+        return NodeInfo(NodeType::OBJ, data);
+    }
+
+    if(std::holds_alternative<int32_t>(data) || std::holds_alternative<float>(data)){
+        return NodeInfo(NodeType::NUM_LIT, data);
+    }
+
+    return NodeInfo(NodeType::STR_LIT, data);
+}
+
 NodeInfo identifierToLiteral(NodeInfo info, ScopeManager &scope){
     Data *data;
     switch(info.type){
@@ -881,15 +1561,7 @@ NodeInfo identifierToLiteral(NodeInfo info, ScopeManager &scope){
         break;
     }
 
-    if(std::holds_alternative<void*>(*data)){
-        return NodeInfo(NodeType::PTR, *data);
-    }
-
-    if(std::holds_alternative<int32_t>(*data) || std::holds_alternative<float>(*data)){
-        return NodeInfo(NodeType::NUM_LIT, *data);
-    }
-
-    return NodeInfo(NodeType::STR_LIT, *data);
+    return dataToLiteral(*data);
 }
 
 NodeInfo invoke(ScopeManager &scope, std::string identifier, std::vector<NodeInfo> &argsList){
@@ -899,64 +1571,102 @@ NodeInfo invoke(ScopeManager &scope, std::string identifier, std::vector<NodeInf
     }
 
     if(Data *data = scope.findData(identifier)){
-        DefStatement *funDefPtr = reinterpret_cast<DefStatement*>(std::get<void*>(*data));
-        std::vector<std::string> paramsList;
-        paramsList.reserve(funDefPtr->getChild(1)->getChildrens().size());
-        for(auto &e : funDefPtr->getChild(1)->getChildrens()){
-            paramsList.emplace_back(std::get<std::string>(e->eval(scope).data));
-        }
-
-        if(paramsList.size() == argsList.size() - 1){
-            scope.pushScope();
-            for(int i = 0; i < paramsList.size(); i++){
-                scope.pushData(paramsList[i], argsList[i + 1].data);
-            }
-
-            NodeInfo _info = funDefPtr->getChild(2)->eval(scope);
-            scope.isReturning = false;
-            scope.popScope();
-            return _info;
-        }else{
-            throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
-        }
+        return callFunction(scope, identifier, *data, argsList, 1);
     }else{
         throw ParserException("~Error~ Undefined Function Identifier \'" + identifier + "\'.");
     }
 }
 
 NodeInfo invoke(ScopeManager &scope, AbstractNode* ptr, std::vector<NodeInfo> &argsList){
-    std::string identifier = ptr->getChild(0)->getValue();
-    if(Data *data = scope.findData(identifier)){
-        DefStatement *funDefPtr = reinterpret_cast<DefStatement*>(std::get<void*>(*data));
-        std::vector<std::string> paramsList;
-        paramsList.reserve(funDefPtr->getChild(1)->getChildrens().size());
-        for(auto &e : funDefPtr->getChild(1)->getChildrens()){
-            paramsList.emplace_back(std::get<std::string>(e->eval(scope).data));
+    return invoke(scope, ptr->getChild(0)->getValue(), argsList);
+}
+
+// A named function sees the scope it is called from, for a tail call the one of the returning call.
+// When the callee's parameters shadow every variable of the returning call, from where it returned
+// up to its frame, none of them is visible and the frame's parent is used instead, so recursion
+// keeps one parent rather than a growing chain of finished frames.
+static std::shared_ptr<SymbolTable> tailCallParent(const std::shared_ptr<SymbolTable> &returningScope, const std::shared_ptr<SymbolTable> &frame, const std::vector<std::shared_ptr<AbstractNode>> &params){
+    auto isParam = [&params](const std::string &name){
+        return std::any_of(params.begin(), params.end(), [&name](const std::shared_ptr<AbstractNode> &e){ return e->getValue() == name; });
+    };
+
+    for(std::shared_ptr<SymbolTable> table = returningScope; table != nullptr; table = table->getParent()){
+        if(!table->definesOnly(isParam)){
+            return returningScope;
+        }
+        if(table == frame){
+            return frame->getParent();
         }
+    }
 
-        if(paramsList.size() == argsList.size() - 1){
-            scope.pushScope();
-            for(int i = 0; i < paramsList.size(); i++){
-                scope.pushData(paramsList[i], argsList[i + 1].data);
-            }
+    return returningScope;
+}
 
-            NodeInfo _info = funDefPtr->getChild(2)->eval(scope);
-            scope.isReturning = false;
-            scope.popScope();
-            return _info;
+// Runs a user function or closure with the arguments from firstArg onwards. Every call gets a frame
+// on the explicit call stack; tail calls prepared by a RetStatement replace the callee and arguments
+// and loop here, so they run in constant native and call stack space. Named functions see the
+// caller's scope while closures run in their defining scope with their upvalues bound.
+NodeInfo callFunction(ScopeManager &scope, std::string identifier, Data callee, std::vector<NodeInfo> &argsList, std::size_t firstArg){
+    std::vector<Data> args;
+    args.reserve(argsList.size() - firstArg);
+    for(std::size_t i = firstArg; i < argsList.size(); ++i){
+        CANVAS_STAT_STRING(argsList[i].data);
+        args.emplace_back(argsList[i].data);
+    }
+
+    CallGuard call(scope, identifier);
+    std::shared_ptr<SymbolTable> callerScope = call.getCallerScope();
+    std::shared_ptr<SymbolTable> frame;
+    std::shared_ptr<SymbolTable> returningScope;
+    while(true){
+        std::vector<std::shared_ptr<AbstractNode>> *params = nullptr;
+        AbstractNode *body = nullptr;
+        ClosureObject *closure = nullptr;
+        if(std::holds_alternative<Ref>(callee) && std::get<Ref>(callee) && std::get<Ref>(callee).get()->kind == HeapObjectType::CLOSURE){
+            closure = std::get<Ref>(callee).as<ClosureObject>();
+            params = &closure->node->getChild(0)->getChildrens();
+            body = closure->node->getChild(1).get();
+        }else if(std::holds_alternative<void*>(callee) && std::get<void*>(callee) != nullptr){
+            DefStatement *funDefPtr = reinterpret_cast<DefStatement*>(std::get<void*>(callee));
+            params = &funDefPtr->getChild(1)->getChildrens();
+            body = funDefPtr->getChild(2).get();
         }else{
+            throw ParserException("~Error~ \'" + identifier + "\' is not a function.");
+        }
+
+        if(params->size() != args.size()){
             throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
         }
-    }else{
-        throw ParserException("~Error~ Undefined Function Identifier \'" + identifier + "\'.");
-    }
-}
 
-NodeInfo invokeLambda(ScopeManager &scope, AbstractNode* ptr, std::vector<NodeInfo> &argsList){
-    scope.pushScope();
-    NodeInfo _info = ptr->getChild(1)->eval(scope);
-    scope.isReturning = false;
-    scope.popScope();
+        if(closure != nullptr){
+            std::shared_ptr<SymbolTable> parentScope = closure->definitionScope.lock();
+            scope.pushFrame(parentScope != nullptr ? parentScope : scope.getGlobalScope());
+            for(auto &e : closure->upvalues){
+                scope.getCurrentScope()->bindUpvalue(e.first, e.second);
+            }
+        }else{
+            scope.pushFrame(returningScope != nullptr ? tailCallParent(returningScope, frame, *params) : callerScope);
+        }
+        frame = scope.getCurrentScope();
+        returningScope = nullptr;
+        for(std::size_t i = 0; i < params->size(); ++i){
+            scope.pushData((*params)[i]->getValue(), args[i]);
+        }
 
-    return _info;
-}
\ No newline at end of file
+        NodeInfo _info = body->eval(scope);
+        scope.completion = Completion::NORMAL;
+        scope.popFrame(callerScope);
+
+        if(!scope.isTailCalling){
+            return _info;
+        }
+
+        scope.isTailCalling = false;
+        identifier = std::move(scope.tailCall.name);
+        callee = std::move(scope.tailCall.callee);
+        args = std::move(scope.tailCall.args);
+        returningScope = std::move(scope.tailCall.scope);
+        scope.tailCall.callee = 0;
+        call.reenter(identifier);
+    }
+}
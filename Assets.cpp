@@ -0,0 +1,162 @@
+#include "headers/Assets.hpp"
+#include "headers/Image.hpp"
+#include "headers/Error.hpp"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char ASSET_CACHE_MAGIC[8] = {'C', 'N', 'V', 'A', 'S', 'S', 'E', 'T'};
+const std::uint32_t ASSET_CACHE_VERSION = 1;
+
+// Helper Functions
+static bool statSource(const std::string &path, std::uint64_t &size, std::int64_t &time){
+    struct stat info;
+    if(stat(path.c_str(), &info) != 0){
+        return false;
+    }
+
+    size = info.st_size;
+    time = info.st_mtime;
+    return true;
+}
+
+static std::size_t alignTo64(std::size_t offset){
+    return (offset + 63) & ~static_cast<std::size_t>(63);
+}
+
+/* AssetCache Class */
+// Constructor & Destructor
+AssetCache::~AssetCache(){
+    if(m_data){
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+}
+
+// Functions
+void AssetCache::open(const std::string &path){
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0){
+        throw ParserException("~Error~ Could not open asset cache \'" + path + "\'.");
+    }
+
+    struct stat info;
+    void *mapping = MAP_FAILED;
+    if(fstat(descriptor, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(AssetCacheHeader))){
+        mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    ::close(descriptor);
+    if(mapping == MAP_FAILED){
+        throw ParserException("~Error~ Could not map asset cache \'" + path + "\'.");
+    }
+
+    if(m_data){
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        m_entries.clear();
+    }
+    m_data = static_cast<const std::uint8_t*>(mapping);
+    m_size = info.st_size;
+
+    // Every offset is checked once here so lookups can trust the table.
+    const AssetCacheHeader *header = reinterpret_cast<const AssetCacheHeader*>(m_data);
+    bool isValid = std::memcmp(header->magic, ASSET_CACHE_MAGIC, 8) == 0 && header->version == ASSET_CACHE_VERSION && header->count <= (m_size - sizeof(AssetCacheHeader)) / sizeof(AssetCacheEntry);
+    const AssetCacheEntry *entries = reinterpret_cast<const AssetCacheEntry*>(m_data + sizeof(AssetCacheHeader));
+    for(std::uint32_t i = 0; isValid && i < header->count; ++i){
+        const AssetCacheEntry &entry = entries[i];
+        std::uint64_t pixelBytes = static_cast<std::uint64_t>(entry.width) * entry.height * 4;
+        isValid = entry.pathOffset <= m_size && entry.pathLength <= m_size - entry.pathOffset && entry.pixelOffset <= m_size && pixelBytes <= m_size - entry.pixelOffset && entry.width > 0 && entry.height > 0 && entry.width <= 65535 && entry.height <= 65535;
+        if(isValid){
+            m_entries.emplace(std::string(reinterpret_cast<const char*>(m_data + entry.pathOffset), entry.pathLength), &entry);
+        }
+    }
+
+    if(!isValid){
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+        m_entries.clear();
+        throw ParserException("~Error~ Invalid asset cache \'" + path + "\'.");
+    }
+}
+
+std::size_t AssetCache::size() const{
+    return m_entries.size();
+}
+
+std::unique_ptr<CanvasObject> AssetCache::find(const std::string &path, Heap *heap) const{
+    auto position = m_entries.find(path);
+    if(position == m_entries.end()){
+        return nullptr;
+    }
+
+    const AssetCacheEntry &entry = *position->second;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    if(statSource(path, sourceSize, sourceTime) && (sourceSize != entry.sourceSize || sourceTime != entry.sourceTime)){
+        return nullptr;
+    }
+
+    if(heap != nullptr){
+        heap->reserve(CanvasObject::byteSizeFor(entry.width, entry.height));
+    }
+    std::unique_ptr<CanvasObject> image = std::make_unique<CanvasObject>(entry.width, entry.height);
+    const std::uint8_t *pixels = m_data + entry.pixelOffset;
+    for(int y = 0; y < image->height; ++y){
+        std::memcpy(image->row(y), pixels + static_cast<std::size_t>(y) * entry.width * 4, entry.width * 4);
+    }
+
+    return image;
+}
+
+// Helper Functions
+// One cache per process, opened before any script runs and only read afterwards.
+AssetCache &assetCache(){
+    static AssetCache cache;
+    return cache;
+}
+
+std::unique_ptr<CanvasObject> loadImage(const std::string &path, Heap *heap){
+    std::unique_ptr<CanvasObject> image = assetCache().find(path, heap);
+    return image ? std::move(image) : loadImageFile(path, heap);
+}
+
+std::size_t writeAssetCache(const std::string &cachePath, const std::vector<std::string> &paths){
+    std::vector<std::unique_ptr<CanvasObject>> images;
+    std::vector<AssetCacheEntry> entries(paths.size());
+    std::size_t offset = sizeof(AssetCacheHeader) + entries.size() * sizeof(AssetCacheEntry);
+    for(std::size_t i = 0; i < paths.size(); ++i){
+        images.emplace_back(loadImageFile(paths[i]));
+        entries[i] = AssetCacheEntry{offset, static_cast<std::uint32_t>(paths[i].size()), static_cast<std::uint32_t>(images[i]->width), static_cast<std::uint32_t>(images[i]->height), 0, 0, 0, 0};
+        statSource(paths[i], entries[i].sourceSize, entries[i].sourceTime);
+        offset += paths[i].size();
+    }
+
+    for(std::size_t i = 0; i < paths.size(); ++i){
+        offset = alignTo64(offset);
+        entries[i].pixelOffset = offset;
+        offset += static_cast<std::size_t>(entries[i].width) * entries[i].height * 4;
+    }
+
+    FileWriter writer(cachePath);
+    AssetCacheHeader header = {};
+    std::memcpy(header.magic, ASSET_CACHE_MAGIC, 8);
+    header.version = ASSET_CACHE_VERSION;
+    header.count = static_cast<std::uint32_t>(entries.size());
+    writer.write(&header, sizeof(header));
+    writer.write(entries.data(), entries.size() * sizeof(AssetCacheEntry));
+    for(const auto &e : paths){
+        writer.write(e.data(), e.size());
+    }
+
+    static const std::uint8_t padding[64] = {0};
+    for(std::size_t i = 0; i < images.size(); ++i){
+        writer.write(padding, entries[i].pixelOffset - writer.written());
+        for(int y = 0; y < images[i]->height; ++y){
+            writer.write(images[i]->row(y), static_cast<std::size_t>(images[i]->width) * 4);
+        }
+    }
+
+    writer.close();
+    return entries.size();
+}
@@ -0,0 +1,748 @@
+#include "headers/Canvas.hpp"
+#include "headers/Raster.hpp"
+#include "headers/Kernels.hpp"
+#include "headers/ThreadPool.hpp"
+#include "headers/Utility.hpp"
+#include "headers/Error.hpp"
+#include <new>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+
+// Helper Functions
+void fillSpan(std::uint32_t *dst, int count, std::uint32_t color){
+    std::uint8_t alpha = colorAlpha(color);
+    if(count == 1){
+        if(alpha == 255){
+            *dst = color;
+        }else if(alpha != 0){
+            *dst = blendPixel(*dst, color);
+        }
+    }else if(alpha == 255){
+        activeKernels().fill(dst, count, color);
+    }else if(alpha != 0){
+        activeKernels().fillBlend(dst, count, color);
+    }
+}
+
+ClipRect intersect(const ClipRect &a, const ClipRect &b){
+    return ClipRect{std::max(a.x0, b.x0), std::max(a.y0, b.y0), std::min(a.x1, b.x1), std::min(a.y1, b.y1)};
+}
+
+// Versions are unique across canvases, a recycled address never matches an old version.
+static std::uint64_t nextCanvasVersion(){
+    static std::atomic<std::uint64_t> counter{0};
+    return ++counter;
+}
+
+/* CanvasObject Struct */
+// Constructor & Destructor
+CanvasObject::CanvasObject(int width, int height, std::uint32_t background) : HeapObject(HeapObjectType::CANVAS), width(width), height(height){
+    stride = (static_cast<std::size_t>(width) + 15) & ~static_cast<std::size_t>(15);
+    MemoryScope memory(MemoryCategory::PIXELS);
+    pixels = static_cast<std::uint32_t*>(::operator new(std::max<std::size_t>(stride * height, 1) * sizeof(std::uint32_t), std::align_val_t(64)));
+    std::fill_n(pixels, stride * height, background);
+
+    version = nextCanvasVersion();
+    tilesX = (width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    tilesY = (height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    dirty.assign(static_cast<std::size_t>(tilesX) * tilesY, 0);
+}
+
+CanvasObject::~CanvasObject(){
+    releaseSources();
+    ::operator delete(pixels, std::align_val_t(64));
+}
+
+// Functions
+std::size_t CanvasObject::byteSize() const{
+    return byteSizeFor(width, height);
+}
+
+std::size_t CanvasObject::byteSizeFor(int width, int height){
+    std::size_t stride = (static_cast<std::size_t>(width) + 15) & ~static_cast<std::size_t>(15);
+    return sizeof(CanvasObject) + stride * height * sizeof(std::uint32_t);
+}
+
+ClipRect CanvasObject::bounds() const{
+    return ClipRect{0, 0, width, height};
+}
+
+void CanvasObject::setPixel(int x, int y, std::uint32_t color){
+    if(x >= 0 && y >= 0 && x < width && y < height){
+        fillSpan(row(y) + x, 1, color);
+    }
+}
+
+// Lines use the closed form of the midpoint rule: step i along the major axis lands on
+// minor = round_half_up(i * dMinor / dMajor). Clipping only narrows the range of i and the error
+// term is computed for the first visible step, so a clipped line touches exactly the pixels the
+// unclipped one would.
+void CanvasObject::drawLine(int x0, int y0, int x1, int y1, std::uint32_t color, const ClipRect &clip){
+    ClipRect area = intersect(clip, bounds());
+    if(area.x0 >= area.x1 || area.y0 >= area.y1){
+        return;
+    }
+
+    std::int64_t dx = static_cast<std::int64_t>(x1) - x0;
+    std::int64_t dy = static_cast<std::int64_t>(y1) - y0;
+    bool isSteep = std::llabs(dy) > std::llabs(dx);
+
+    std::int64_t major0 = isSteep ? y0 : x0;
+    std::int64_t minor0 = isSteep ? x0 : y0;
+    std::int64_t dMajor = isSteep ? dy : dx;
+    std::int64_t dMinor = isSteep ? dx : dy;
+    int majorStep = dMajor < 0 ? -1 : 1;
+    int minorStep = dMinor < 0 ? -1 : 1;
+    dMajor = std::llabs(dMajor);
+    dMinor = std::llabs(dMinor);
+
+    std::int64_t majorLow = isSteep ? area.y0 : area.x0;
+    std::int64_t majorHigh = (isSteep ? area.y1 : area.x1) - 1;
+    std::int64_t minorLow = isSteep ? area.x0 : area.y0;
+    std::int64_t minorHigh = (isSteep ? area.x1 : area.y1) - 1;
+
+    // Range of steps whose major coordinate is inside the clip area.
+    std::int64_t first = majorStep > 0 ? majorLow - major0 : major0 - majorHigh;
+    std::int64_t last = majorStep > 0 ? majorHigh - major0 : major0 - majorLow;
+    first = std::max<std::int64_t>(first, 0);
+    last = std::min<std::int64_t>(last, dMajor);
+    if(first > last){
+        return;
+    }
+
+    std::int64_t denominator = 2 * std::max<std::int64_t>(dMajor, 1);
+    std::int64_t numerator = 2 * first * dMinor + dMajor;
+    std::int64_t quotient = numerator / denominator;
+    std::int64_t remainder = numerator % denominator;
+
+    for(std::int64_t i = first; i <= last; ++i){
+        std::int64_t major = major0 + majorStep * i;
+        std::int64_t minor = minor0 + minorStep * quotient;
+        if(minor >= minorLow && minor <= minorHigh){
+            if(isSteep){
+                fillSpan(row(major) + minor, 1, color);
+            }else{
+                fillSpan(row(minor) + major, 1, color);
+            }
+        }
+
+        remainder += 2 * dMinor;
+        if(remainder >= denominator){
+            remainder -= denominator;
+            ++quotient;
+        }
+    }
+}
+
+void CanvasObject::drawRect(int x, int y, int w, int h, std::uint32_t color, const ClipRect &clip){
+    if(w <= 0 || h <= 0){
+        return;
+    }
+
+    fillRect(x, y, w, 1, color, clip);
+    if(h > 1){
+        fillRect(x, y + h - 1, w, 1, color, clip);
+    }
+    if(h > 2){
+        fillRect(x, y + 1, 1, h - 2, color, clip);
+        if(w > 1){
+            fillRect(x + w - 1, y + 1, 1, h - 2, color, clip);
+        }
+    }
+}
+
+void CanvasObject::fillRect(int x, int y, int w, int h, std::uint32_t color, const ClipRect &clip){
+    if(w <= 0 || h <= 0){
+        return;
+    }
+
+    ClipRect rect = {x, y, static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + w, INT32_MAX)), static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + h, INT32_MAX))};
+    ClipRect area = intersect(intersect(rect, clip), bounds());
+    if(area.x0 >= area.x1){
+        return;
+    }
+
+    for(int rowIndex = area.y0; rowIndex < area.y1; ++rowIndex){
+        fillSpan(row(rowIndex) + area.x0, area.x1 - area.x0, color);
+    }
+}
+
+void CanvasObject::clear(std::uint32_t color, const ClipRect &clip){
+    ClipRect area = intersect(clip, bounds());
+    if(area.x0 >= area.x1){
+        return;
+    }else if(area.x0 == 0 && area.x1 == width){
+        // Whole rows, padding included, are one contiguous span.
+        if(area.y0 < area.y1){
+            activeKernels().fill(row(area.y0), stride * (area.y1 - area.y0), color);
+        }
+        return;
+    }
+
+    for(int rowIndex = area.y0; rowIndex < area.y1; ++rowIndex){
+        activeKernels().fill(row(rowIndex) + area.x0, area.x1 - area.x0, color);
+    }
+}
+
+// Draws the region of src with its top left corner at (x, y), composited source-over or copied
+// verbatim. The region must lie inside src.
+void CanvasObject::blit(CanvasObject &src, const ClipRect &region, int x, int y, bool isBlending, const ClipRect &clip){
+    int regionWidth = region.x1 - region.x0;
+    int regionHeight = region.y1 - region.y0;
+    ClipRect rect = {x, y, static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + regionWidth, INT32_MAX)), static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + regionHeight, INT32_MAX))};
+    ClipRect area = intersect(intersect(rect, clip), bounds());
+    if(area.x0 >= area.x1){
+        return;
+    }
+
+    const PixelKernels &kernels = activeKernels();
+    for(int rowIndex = area.y0; rowIndex < area.y1; ++rowIndex){
+        std::uint32_t *dst = row(rowIndex) + area.x0;
+        const std::uint32_t *source = src.row(region.y0 + rowIndex - y) + (region.x0 + area.x0 - x);
+        if(isBlending){
+            kernels.copyBlend(dst, source, area.x1 - area.x0);
+        }else{
+            kernels.copy(dst, source, area.x1 - area.x0);
+        }
+    }
+}
+
+// Linear gradient across the rect. Horizontal gradients compute the visible part of one row and
+// copy it to every row, vertical ones are a solid span per row.
+void CanvasObject::fillGradient(int x, int y, int w, int h, std::uint32_t from, std::uint32_t to, bool isVertical, const ClipRect &clip){
+    if(w <= 0 || h <= 0){
+        return;
+    }
+
+    ClipRect rect = {x, y, static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + w, INT32_MAX)), static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + h, INT32_MAX))};
+    ClipRect area = intersect(intersect(rect, clip), bounds());
+    if(area.x0 >= area.x1 || area.y0 >= area.y1){
+        return;
+    }
+
+    if(isVertical){
+        for(int rowIndex = area.y0; rowIndex < area.y1; ++rowIndex){
+            fillSpan(row(rowIndex) + area.x0, area.x1 - area.x0, gradientColorAt(from, to, rowIndex - y, h));
+        }
+        return;
+    }
+
+    std::vector<std::uint32_t> span(area.x1 - area.x0);
+    for(std::size_t i = 0; i < span.size(); ++i){
+        span[i] = gradientColorAt(from, to, area.x0 - x + i, w);
+    }
+
+    const PixelKernels &kernels = activeKernels();
+    bool isOpaque = colorAlpha(from) == 255 && colorAlpha(to) == 255;
+    for(int rowIndex = area.y0; rowIndex < area.y1; ++rowIndex){
+        if(isOpaque){
+            kernels.copy(row(rowIndex) + area.x0, span.data(), span.size());
+        }else{
+            kernels.copyBlend(row(rowIndex) + area.x0, span.data(), span.size());
+        }
+    }
+}
+
+// Blits are recorded like any other command inside a batch or a frame, otherwise they are drawn
+// straight away. A canvas drawn onto itself always draws immediately since rows may overlap.
+void CanvasObject::drawImage(CanvasObject &src, const ClipRect &region, int x, int y, bool isBlending){
+    src.flush();
+    int regionWidth = region.x1 - region.x0;
+    int regionHeight = region.y1 - region.y0;
+    if(!isBatching || &src == this){
+        flush();
+        ClipRect rect = {x, y, static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + regionWidth, INT32_MAX)), static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + regionHeight, INT32_MAX))};
+        ClipRect area = intersect(rect, bounds());
+        if(area.x0 < area.x1 && area.y0 < area.y1){
+            flushReaders();
+            touch(area);
+            blit(src, region, x, y, isBlending, bounds());
+        }
+        return;
+    }
+
+    if(std::find(src.readers.begin(), src.readers.end(), this) == src.readers.end()){
+        src.readers.emplace_back(this);
+    }
+    blitSources.emplace_back(BlitSource{Ref(&src), region, src.version, isBlending});
+    record(DrawCommand{DrawCommandType::BLIT, x, y, regionWidth, regionHeight, static_cast<std::uint32_t>(blitSources.size() - 1)});
+}
+
+// Shapes and gradients are recorded with their parameters in a ShapeSource, so a frame can compare
+// them with the previous one like any other command.
+void CanvasObject::drawShape(std::vector<Contour> contours, std::uint32_t color){
+    int minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+    for(const Contour &contour : contours){
+        for(const FixedPoint &point : contour){
+            minX = std::min(minX, point.x);
+            minY = std::min(minY, point.y);
+            maxX = std::max(maxX, point.x);
+            maxY = std::max(maxY, point.y);
+        }
+    }
+
+    if(minX > maxX || colorAlpha(color) == 0){
+        return;
+    }
+
+    int x = minX >> 8;
+    int y = minY >> 8;
+    std::shared_ptr<ShapeSource> shape = std::make_shared<ShapeSource>();
+    shape->contours = std::move(contours);
+    shape->color = color;
+    shapeSources.emplace_back(std::move(shape));
+    record(DrawCommand{DrawCommandType::SHAPE, x, y, ((maxX + 255) >> 8) - x, ((maxY + 255) >> 8) - y, static_cast<std::uint32_t>(shapeSources.size() - 1)});
+}
+
+void CanvasObject::drawGradient(int x, int y, int w, int h, std::uint32_t from, std::uint32_t to, bool isVertical){
+    if(w <= 0 || h <= 0){
+        return;
+    }
+
+    std::shared_ptr<ShapeSource> gradient = std::make_shared<ShapeSource>();
+    gradient->color = from;
+    gradient->to = to;
+    gradient->isVertical = isVertical;
+    shapeSources.emplace_back(std::move(gradient));
+    record(DrawCommand{DrawCommandType::GRADIENT, x, y, w, h, static_cast<std::uint32_t>(shapeSources.size() - 1)});
+}
+
+void CanvasObject::record(const DrawCommand &command){
+    pending.emplace_back(command);
+    if(!isBatching && pending.size() >= MAX_PENDING_COMMANDS){
+        flush();
+    }
+}
+
+void CanvasObject::execute(const DrawCommand &command, const ClipRect &clip){
+    switch(command.type){
+    case DrawCommandType::PIXEL:
+        if(command.x0 >= clip.x0 && command.x0 < clip.x1 && command.y0 >= clip.y0 && command.y0 < clip.y1){
+            setPixel(command.x0, command.y0, command.color);
+        }
+        break;
+    case DrawCommandType::LINE:
+        drawLine(command.x0, command.y0, command.x1, command.y1, command.color, clip);
+        break;
+    case DrawCommandType::RECT:
+        drawRect(command.x0, command.y0, command.x1, command.y1, command.color, clip);
+        break;
+    case DrawCommandType::FILL_RECT:
+        fillRect(command.x0, command.y0, command.x1, command.y1, command.color, clip);
+        break;
+    case DrawCommandType::CLEAR:
+        clear(command.color, clip);
+        break;
+    case DrawCommandType::BLIT:{
+        const BlitSource &source = blitSources[command.color];
+        blit(*source.canvas.as<CanvasObject>(), source.region, command.x0, command.y0, source.isBlending, clip);
+        break;
+    }
+    case DrawCommandType::SHAPE:{
+        const ShapeSource &shape = *shapeSources[command.color];
+        fillContours(*this, shape.contours, shape.color, clip);
+        break;
+    }
+    case DrawCommandType::GRADIENT:{
+        const ShapeSource &gradient = *shapeSources[command.color];
+        fillGradient(command.x0, command.y0, command.x1, command.y1, gradient.color, gradient.to, gradient.isVertical, clip);
+        break;
+    }
+    }
+}
+
+static bool contains(const ClipRect &outer, const ClipRect &inner){
+    return inner.x0 >= outer.x0 && inner.y0 >= outer.y0 && inner.x1 <= outer.x1 && inner.y1 <= outer.y1;
+}
+
+// Bounding box of the pixels a command can touch, clipped to the canvas.
+static ClipRect commandBounds(const DrawCommand &command, const ClipRect &canvasBounds){
+    ClipRect box = {0, 0, 0, 0};
+    switch(command.type){
+    case DrawCommandType::PIXEL:
+        box = {command.x0, command.y0, command.x0 + 1, command.y0 + 1};
+        break;
+    case DrawCommandType::LINE:
+        box = {std::min(command.x0, command.x1), std::min(command.y0, command.y1), std::max(command.x0, command.x1) + 1, std::max(command.y0, command.y1) + 1};
+        break;
+    case DrawCommandType::RECT:
+    case DrawCommandType::FILL_RECT:
+    case DrawCommandType::BLIT:
+    case DrawCommandType::SHAPE:
+    case DrawCommandType::GRADIENT:
+        box = {command.x0, command.y0, static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(command.x0) + command.x1, INT32_MAX)), static_cast<int>(std::min<std::int64_t>(static_cast<std::int64_t>(command.y0) + command.y1, INT32_MAX))};
+        break;
+    case DrawCommandType::CLEAR:
+        box = canvasBounds;
+        break;
+    }
+
+    return intersect(box, canvasBounds);
+}
+
+// Small canvases replay the commands in order. Large ones bin every command into the tiles its
+// bounding box overlaps and rasterise the tiles in parallel; each tile replays its commands in
+// submission order clipped to the tile, and every primitive clips exactly, so the result is the
+// same as the sequential replay.
+std::size_t CanvasObject::flush(){
+    if(pending.empty()){
+        return 0;
+    }
+
+    flushReaders();
+    ClipRect canvasBounds = bounds();
+    cullOccludedCommands(pending, canvasBounds);
+    coalesceCommands(pending);
+
+    std::size_t commandCount = pending.size();
+    if(static_cast<std::size_t>(width) * height < PARALLEL_RASTER_PIXELS || sharedThreadPool().size() == 0){
+        for(auto &e : pending){
+            markDirtyTiles(commandBounds(e, canvasBounds));
+            execute(e, canvasBounds);
+        }
+        version = nextCanvasVersion();
+        pending.clear();
+        releaseSources();
+        return commandCount;
+    }
+
+    int rasterTilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int rasterTilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    std::vector<std::vector<std::uint32_t>> bins(rasterTilesX * rasterTilesY);
+    for(std::uint32_t i = 0; i < pending.size(); ++i){
+        ClipRect box = commandBounds(pending[i], canvasBounds);
+        if(box.x0 >= box.x1 || box.y0 >= box.y1){
+            continue;
+        }
+
+        markDirtyTiles(box);
+        for(int tileY = box.y0 / RASTER_TILE_SIZE; tileY <= (box.y1 - 1) / RASTER_TILE_SIZE; ++tileY){
+            for(int tileX = box.x0 / RASTER_TILE_SIZE; tileX <= (box.x1 - 1) / RASTER_TILE_SIZE; ++tileX){
+                bins[tileY * rasterTilesX + tileX].emplace_back(i);
+            }
+        }
+    }
+
+    sharedThreadPool().parallelFor(bins.size(), [&](std::size_t tile){
+        int tileX = (tile % rasterTilesX) * RASTER_TILE_SIZE;
+        int tileY = (tile / rasterTilesX) * RASTER_TILE_SIZE;
+        ClipRect clip = {tileX, tileY, std::min(tileX + RASTER_TILE_SIZE, width), std::min(tileY + RASTER_TILE_SIZE, height)};
+        for(std::uint32_t e : bins[tile]){
+            execute(pending[e], clip);
+        }
+    });
+    version = nextCanvasVersion();
+    pending.clear();
+    releaseSources();
+
+    return commandCount;
+}
+
+void CanvasObject::markDirtyTiles(const ClipRect &box){
+    if(box.x0 >= box.x1 || box.y0 >= box.y1){
+        return;
+    }
+
+    for(int tileY = box.y0 / DIRTY_TILE_SIZE; tileY <= (box.y1 - 1) / DIRTY_TILE_SIZE; ++tileY){
+        std::fill_n(dirty.begin() + tileY * tilesX + box.x0 / DIRTY_TILE_SIZE, (box.x1 - 1) / DIRTY_TILE_SIZE - box.x0 / DIRTY_TILE_SIZE + 1, 1);
+    }
+}
+
+// Called by everything that writes pixels outside of flush(), box must lie inside the canvas.
+void CanvasObject::touch(const ClipRect &box){
+    markDirtyTiles(box);
+    version = nextCanvasVersion();
+}
+
+void CanvasObject::flushReaders(){
+    while(!readers.empty()){
+        readers.back()->flush();
+    }
+}
+
+void CanvasObject::releaseSources(){
+    for(auto &e : blitSources){
+        std::vector<CanvasObject*> &sourceReaders = e.canvas.as<CanvasObject>()->readers;
+        sourceReaders.erase(std::remove(sourceReaders.begin(), sourceReaders.end(), this), sourceReaders.end());
+    }
+    blitSources.clear();
+    shapeSources.clear();
+}
+
+void CanvasObject::beginFrame(){
+    isBatching = true;
+    isFraming = true;
+}
+
+// Whether the command replaces every pixel of the tile, whatever was there before.
+static bool coversTile(const DrawCommand &command, const std::vector<BlitSource> &sources, const std::vector<std::shared_ptr<const ShapeSource>> &shapes, const ClipRect &box, const ClipRect &tile){
+    switch(command.type){
+    case DrawCommandType::CLEAR:
+        return true;
+    case DrawCommandType::FILL_RECT:
+        return colorAlpha(command.color) == 255 && contains(box, tile);
+    case DrawCommandType::BLIT:
+        return !sources[command.color].isBlending && contains(box, tile);
+    case DrawCommandType::GRADIENT:
+        return colorAlpha(shapes[command.color]->color) == 255 && colorAlpha(shapes[command.color]->to) == 255 && contains(box, tile);
+    default:
+        return false;
+    }
+}
+
+static bool isSameShape(const ShapeSource &a, const ShapeSource &b){
+    if(a.color != b.color || a.to != b.to || a.isVertical != b.isVertical || a.contours.size() != b.contours.size()){
+        return false;
+    }
+
+    for(std::size_t i = 0; i < a.contours.size(); ++i){
+        auto isSamePoint = [](const FixedPoint &p, const FixedPoint &q){
+            return p.x == q.x && p.y == q.y;
+        };
+        if(!std::equal(a.contours[i].begin(), a.contours[i].end(), b.contours[i].begin(), b.contours[i].end(), isSamePoint)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool isSameCommand(const RetainedCommand &a, const RetainedCommand &b){
+    const DrawCommand &left = a.command;
+    const DrawCommand &right = b.command;
+    if(left.type != right.type || left.x0 != right.x0 || left.y0 != right.y0 || left.x1 != right.x1 || left.y1 != right.y1){
+        return false;
+    }else if(left.type == DrawCommandType::SHAPE || left.type == DrawCommandType::GRADIENT){
+        return isSameShape(*a.shape, *b.shape);
+    }else if(left.type != DrawCommandType::BLIT){
+        return left.color == right.color;
+    }
+
+    return a.source == b.source && a.version == b.version && a.isBlending == b.isBlending && a.region.x0 == b.region.x0 && a.region.y0 == b.region.y0 && a.region.x1 == b.region.x1 && a.region.y1 == b.region.y1;
+}
+
+// Ends a frame. Commands are binned into dirty tiles and each tile keeps only what follows the
+// last command covering it. A tile that was not touched since the previous frame and draws exactly
+// the same covered list again already holds the right pixels and is skipped; every other tile with
+// commands is redrawn. Redrawn tiles and changes made between frames form the frame's dirty set.
+const FrameStats &CanvasObject::endFrame(){
+    auto start = std::chrono::steady_clock::now();
+    isBatching = false;
+    isFraming = false;
+    flushReaders();
+
+    ClipRect canvasBounds = bounds();
+    cullOccludedCommands(pending, canvasBounds);
+    coalesceCommands(pending);
+
+    std::size_t tileCount = dirty.size();
+    std::vector<ClipRect> boxes(pending.size());
+    std::vector<std::vector<std::uint32_t>> bins(tileCount);
+    for(std::uint32_t i = 0; i < pending.size(); ++i){
+        ClipRect box = commandBounds(pending[i], canvasBounds);
+        boxes[i] = box;
+        if(box.x0 >= box.x1 || box.y0 >= box.y1){
+            continue;
+        }
+
+        for(int tileY = box.y0 / DIRTY_TILE_SIZE; tileY <= (box.y1 - 1) / DIRTY_TILE_SIZE; ++tileY){
+            for(int tileX = box.x0 / DIRTY_TILE_SIZE; tileX <= (box.x1 - 1) / DIRTY_TILE_SIZE; ++tileX){
+                bins[tileY * tilesX + tileX].emplace_back(i);
+            }
+        }
+    }
+
+    bool hasPrevious = frameTiles.size() == tileCount;
+    frameTiles.resize(tileCount);
+    std::vector<std::uint8_t> isRedrawn(tileCount, 0);
+    auto drawTile = [&](std::size_t tile){
+        const std::vector<std::uint32_t> &bin = bins[tile];
+        if(bin.empty()){
+            frameTiles[tile].clear();
+            return;
+        }
+
+        int tileX = (tile % tilesX) * DIRTY_TILE_SIZE;
+        int tileY = (tile / tilesX) * DIRTY_TILE_SIZE;
+        ClipRect clip = {tileX, tileY, std::min(tileX + DIRTY_TILE_SIZE, width), std::min(tileY + DIRTY_TILE_SIZE, height)};
+        std::size_t first = 0;
+        bool isCovered = false;
+        for(std::size_t i = bin.size(); i-- > 0;){
+            if(coversTile(pending[bin[i]], blitSources, shapeSources, boxes[bin[i]], clip)){
+                first = i;
+                isCovered = true;
+                break;
+            }
+        }
+
+        std::vector<RetainedCommand> commands(bin.size() - first);
+        for(std::size_t i = first; i < bin.size(); ++i){
+            RetainedCommand &retained = commands[i - first];
+            retained.command = pending[bin[i]];
+            if(retained.command.type == DrawCommandType::BLIT){
+                const BlitSource &source = blitSources[retained.command.color];
+                retained.source = source.canvas.as<CanvasObject>();
+                retained.version = source.version;
+                retained.region = source.region;
+                retained.isBlending = source.isBlending;
+            }else if(retained.command.type == DrawCommandType::SHAPE || retained.command.type == DrawCommandType::GRADIENT){
+                retained.shape = shapeSources[retained.command.color];
+            }
+        }
+
+        std::vector<RetainedCommand> &previous = frameTiles[tile];
+        if(hasPrevious && isCovered && dirty[tile] == 0 && previous.size() == commands.size() && std::equal(commands.begin(), commands.end(), previous.begin(), isSameCommand)){
+            return;
+        }
+
+        for(std::size_t i = first; i < bin.size(); ++i){
+            execute(pending[bin[i]], clip);
+        }
+        dirty[tile] = 1;
+        isRedrawn[tile] = 1;
+        previous = std::move(commands);
+    };
+
+    if(static_cast<std::size_t>(width) * height < PARALLEL_RASTER_PIXELS || sharedThreadPool().size() == 0){
+        for(std::size_t tile = 0; tile < tileCount; ++tile){
+            drawTile(tile);
+        }
+    }else{
+        sharedThreadPool().parallelFor(tileCount, drawTile);
+    }
+
+    frameStats.frames++;
+    frameStats.dirtyPixels = 0;
+    frameStats.dirtyTiles = 0;
+    frameStats.redrawnTiles = 0;
+    frameStats.skippedTiles = 0;
+    for(std::size_t tile = 0; tile < tileCount; ++tile){
+        if(isRedrawn[tile]){
+            frameStats.redrawnTiles++;
+        }else if(!bins[tile].empty()){
+            frameStats.skippedTiles++;
+        }
+
+        if(dirty[tile]){
+            int tileX = (tile % tilesX) * DIRTY_TILE_SIZE;
+            int tileY = (tile / tilesX) * DIRTY_TILE_SIZE;
+            frameStats.dirtyTiles++;
+            frameStats.dirtyPixels += static_cast<std::size_t>(std::min(DIRTY_TILE_SIZE, width - tileX)) * std::min(DIRTY_TILE_SIZE, height - tileY);
+        }
+    }
+
+    if(frameStats.redrawnTiles > 0){
+        version = nextCanvasVersion();
+    }
+    frameDirty = dirty;
+    std::fill(dirty.begin(), dirty.end(), 0);
+    pending.clear();
+    releaseSources();
+
+    frameStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return frameStats;
+}
+
+// Merges neighbouring commands that draw the same colour into one rect: pixel runs along a row and
+// rects that continue each other horizontally or vertically. Merged commands never overlap, so
+// translucent colours still blend once per pixel.
+void coalesceCommands(std::vector<DrawCommand> &commands){
+    std::size_t count = 0;
+    for(auto &e : commands){
+        DrawCommand command = e;
+        if(command.type == DrawCommandType::PIXEL){
+            command = DrawCommand{DrawCommandType::FILL_RECT, command.x0, command.y0, 1, 1, command.color};
+        }
+
+        if(count > 0 && command.type == DrawCommandType::FILL_RECT){
+            DrawCommand &last = commands[count - 1];
+            if(last.type == DrawCommandType::FILL_RECT && last.color == command.color){
+                if(last.y0 == command.y0 && last.y1 == command.y1 && static_cast<std::int64_t>(last.x0) + last.x1 == command.x0 && static_cast<std::int64_t>(last.x1) + command.x1 <= INT32_MAX){
+                    last.x1 += command.x1;
+                    continue;
+                }else if(last.x0 == command.x0 && last.x1 == command.x1 && static_cast<std::int64_t>(last.y0) + last.y1 == command.y0 && static_cast<std::int64_t>(last.y1) + command.y1 <= INT32_MAX){
+                    last.y1 += command.y1;
+                    continue;
+                }
+            }
+        }
+
+        commands[count++] = command;
+    }
+    commands.resize(count);
+}
+
+// Translucent primitives. A clear replaces pixels whatever its alpha, blits, shapes and gradients
+// keep the index of their source in color.
+static bool drawsNothing(const DrawCommand &command){
+    switch(command.type){
+    case DrawCommandType::PIXEL:
+    case DrawCommandType::LINE:
+    case DrawCommandType::RECT:
+    case DrawCommandType::FILL_RECT:
+        return colorAlpha(command.color) == 0;
+    default:
+        return false;
+    }
+}
+
+// Drops commands whose pixels are all overwritten later by an opaque fill or a clear, and
+// translucent commands that draw nothing. Only the most recent occluders are kept so the pass
+// stays linear.
+void cullOccludedCommands(std::vector<DrawCommand> &commands, const ClipRect &canvasBounds){
+    const std::size_t MAX_OCCLUDERS = 8;
+    std::vector<ClipRect> occluders;
+    std::vector<bool> isCulled(commands.size(), false);
+    bool isFullyCovered = false;
+
+    for(std::size_t i = commands.size(); i-- > 0;){
+        const DrawCommand &command = commands[i];
+        ClipRect box = commandBounds(command, canvasBounds);
+        if(isFullyCovered || box.x0 >= box.x1 || box.y0 >= box.y1 || drawsNothing(command)){
+            isCulled[i] = true;
+            continue;
+        }
+
+        for(auto &e : occluders){
+            if(contains(e, box)){
+                isCulled[i] = true;
+                break;
+            }
+        }
+        if(isCulled[i]){
+            continue;
+        }
+
+        if(command.type == DrawCommandType::CLEAR || (command.type == DrawCommandType::FILL_RECT && colorAlpha(command.color) == 255)){
+            if(contains(box, canvasBounds)){
+                isFullyCovered = true;
+            }else if(occluders.size() < MAX_OCCLUDERS){
+                occluders.emplace_back(box);
+            }
+        }
+    }
+
+    std::size_t count = 0;
+    for(std::size_t i = 0; i < commands.size(); ++i){
+        if(!isCulled[i]){
+            commands[count++] = commands[i];
+        }
+    }
+    commands.resize(count);
+}
+
+// Helper Functions
+int toCoordinate(Data &data){
+    return static_cast<int>(std::clamp(std::floor(variantAsNum(data)), -1073741824.0f, 1073741824.0f));
+}
+
+CanvasObject *asCanvas(const Data &data, const std::string &identifier){
+    if(const auto *refPtr = std::get_if<Ref>(&data)){
+        if(*refPtr && refPtr->get()->kind == HeapObjectType::CANVAS){
+            return refPtr->as<CanvasObject>();
+        }
+    }
+
+    throw ParserException("~Error~ \'" + identifier + "\' expects a canvas.");
+}
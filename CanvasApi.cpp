@@ -0,0 +1,265 @@
+#include "headers/CanvasApi.h"
+#include "headers/Interpreter.hpp"
+#include <sstream>
+
+struct canvas_interpreter{
+    // Variables
+    Interpreter interpreter;
+    NativeRegistry natives;
+    ExecutionLimits limits;
+    std::string lastError;
+};
+
+struct canvas_program{
+    // Variables
+    std::shared_ptr<const Program> program;
+};
+
+// Functions point into the tree that defined them, Program::run keeps every tree run in the scope
+// alive in ScopeManager::sources.
+struct canvas_scope{
+    // Variables
+    ScopeManager scope;
+};
+
+struct canvas_call{
+    // Variables
+    std::vector<NodeInfo> *args;
+    NodeInfo result;
+    std::string error;
+};
+
+// Helper Functions
+// Strings are stored with their quotes, the view leaves them out.
+static canvas_string_view toStringView(const std::string &str){
+    if(str.size() >= 2 && str.front() == '\"' && str.back() == '\"'){
+        return canvas_string_view{str.data() + 1, str.size() - 2};
+    }
+
+    return canvas_string_view{str.data(), str.size()};
+}
+
+static canvas_type toType(const Data &data){
+    if(std::holds_alternative<void*>(data)){
+        return std::get<void*>(data) == nullptr ? CANVAS_NONE : CANVAS_FUNCTION;
+    }
+    if(std::holds_alternative<Ref>(data)){
+        return CANVAS_OBJECT;
+    }
+    if(std::holds_alternative<std::int32_t>(data) || std::holds_alternative<float>(data)){
+        return CANVAS_NUMBER;
+    }
+
+    return CANVAS_STRING;
+}
+
+// Colours are int32 words and are read exactly, every other number is a float.
+static double toNumber(Data &data){
+    if(const auto *intPtr = std::get_if<std::int32_t>(&data)){
+        return *intPtr;
+    }
+
+    return variantAsNum(data);
+}
+
+static void prepareScope(canvas_interpreter *interpreter, ScopeManager &scope){
+    scope.applyLimits(interpreter->limits);
+    scope.natives = &interpreter->natives;
+}
+
+// Assigns to the variable where it is visible, new ones go to the global scope.
+static void setGlobal(canvas_scope *scope, const char *name, const Data &value){
+    if(Data *data = scope->scope.findData(name)){
+        *data = value;
+    }else{
+        scope->scope.pushData(name, value);
+    }
+}
+
+/* Interpreter */
+canvas_interpreter *canvas_interpreter_new(void){
+    try{
+        return new canvas_interpreter();
+    }catch(const std::exception&){
+        return nullptr;
+    }
+}
+
+void canvas_interpreter_free(canvas_interpreter *interpreter){
+    delete interpreter;
+}
+
+void canvas_set_limits(canvas_interpreter *interpreter, size_t max_heap, size_t max_call_depth){
+    interpreter->limits.maxHeap = max_heap;
+    interpreter->limits.maxCallDepth = max_call_depth == 0 ? DEFAULT_MAX_CALL_DEPTH : max_call_depth;
+}
+
+void canvas_set_budget(canvas_interpreter *interpreter, unsigned long long max_steps, unsigned long long timeout_ms){
+    interpreter->limits.maxSteps = max_steps;
+    interpreter->limits.timeout = std::chrono::milliseconds(timeout_ms);
+}
+
+const char *canvas_last_error(const canvas_interpreter *interpreter){
+    return interpreter->lastError.c_str();
+}
+
+int canvas_register_native(canvas_interpreter *interpreter, const char *name, canvas_native_fn function, void *user_data){
+    if(name == nullptr || function == nullptr){
+        interpreter->lastError = "~Error~ Invalid native function.";
+        return -1;
+    }
+
+    std::string identifier = name;
+    interpreter->natives.add(identifier, [identifier, function, user_data](ScopeManager&, std::vector<NodeInfo> &argsList){
+        canvas_call call{&argsList, NodeInfo(), ""};
+        if(function(&call, user_data) != 0 || !call.error.empty()){
+            throw ParserException("~Error~ " + (call.error.empty() ? "Native function failed" : call.error) + " in \'" + identifier + "\'.");
+        }
+
+        return call.result;
+    });
+    return 0;
+}
+
+/* Programs */
+canvas_program *canvas_compile(canvas_interpreter *interpreter, const char *source, size_t size){
+    try{
+        std::istringstream stream(std::string(source, size));
+        std::shared_ptr<const Program> program = interpreter->interpreter.compile(loadSourceAsCode(stream));
+        if(program == nullptr){
+            interpreter->lastError = "~Error~ Nothing to compile.";
+            return nullptr;
+        }
+
+        return new canvas_program{program};
+    }catch(const Error &e){
+        interpreter->lastError = e.what();
+    }catch(const std::exception &e){
+        interpreter->lastError = std::string("~Error~ ") + e.what();
+    }
+
+    return nullptr;
+}
+
+void canvas_program_free(canvas_program *program){
+    delete program;
+}
+
+/* Scopes */
+canvas_scope *canvas_scope_new(canvas_interpreter *interpreter){
+    try{
+        canvas_scope *scope = new canvas_scope();
+        prepareScope(interpreter, scope->scope);
+        return scope;
+    }catch(const std::exception &e){
+        interpreter->lastError = std::string("~Error~ ") + e.what();
+        return nullptr;
+    }
+}
+
+void canvas_scope_free(canvas_scope *scope){
+    delete scope;
+}
+
+// Runs on a thread with a native stack sized for the call depth like the canvas executable, the
+// call blocks until the program finished.
+int canvas_run(canvas_interpreter *interpreter, canvas_program *program, canvas_scope *scope){
+    try{
+        runWithStackSize(nativeStackSizeFor(interpreter->limits.maxCallDepth), [&](){
+            if(scope == nullptr){
+                ScopeManager freshScope;
+                prepareScope(interpreter, freshScope);
+                program->program->run(freshScope);
+                return;
+            }
+
+            prepareScope(interpreter, scope->scope);
+            try{
+                program->program->run(scope->scope);
+            }catch(...){
+                scope->scope.unwind();
+                throw;
+            }
+        });
+    }catch(const LimitError &e){
+        interpreter->lastError = e.what();
+        return CANVAS_LIMIT_EXCEEDED;
+    }catch(const Error &e){
+        interpreter->lastError = e.what();
+        return -1;
+    }catch(const std::exception &e){
+        interpreter->lastError = std::string("~Error~ ") + e.what();
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Globals */
+canvas_type canvas_get_type(canvas_scope *scope, const char *name){
+    Data *data = scope->scope.findData(name);
+    return data == nullptr ? CANVAS_NONE : toType(*data);
+}
+
+int canvas_get_number(canvas_scope *scope, const char *name, double *value){
+    Data *data = scope->scope.findData(name);
+    if(data == nullptr || toType(*data) != CANVAS_NUMBER){
+        return -1;
+    }
+
+    *value = toNumber(*data);
+    return 0;
+}
+
+int canvas_get_string(canvas_scope *scope, const char *name, canvas_string_view *value){
+    Data *data = scope->scope.findData(name);
+    if(data == nullptr || toType(*data) != CANVAS_STRING){
+        return -1;
+    }
+
+    *value = toStringView(std::get<std::string>(*data));
+    return 0;
+}
+
+int canvas_set_number(canvas_scope *scope, const char *name, double value){
+    setGlobal(scope, name, static_cast<float>(value));
+    return 0;
+}
+
+int canvas_set_string(canvas_scope *scope, const char *name, const char *value, size_t size){
+    setGlobal(scope, name, '\"' + std::string(value, size) + '\"');
+    return 0;
+}
+
+/* Native Calls */
+size_t canvas_arg_count(const canvas_call *call){
+    return call->args->size();
+}
+
+canvas_type canvas_arg_type(const canvas_call *call, size_t index){
+    return index < call->args->size() ? toType((*call->args)[index].data) : CANVAS_NONE;
+}
+
+double canvas_arg_number(const canvas_call *call, size_t index){
+    return canvas_arg_type(call, index) == CANVAS_NUMBER ? toNumber((*call->args)[index].data) : 0.0;
+}
+
+canvas_string_view canvas_arg_string(const canvas_call *call, size_t index){
+    if(canvas_arg_type(call, index) != CANVAS_STRING){
+        return canvas_string_view{"", 0};
+    }
+
+    return toStringView(std::get<std::string>((*call->args)[index].data));
+}
+
+void canvas_return_number(canvas_call *call, double value){
+    call->result = NodeInfo(NodeType::NUM_LIT, static_cast<float>(value));
+}
+
+void canvas_return_string(canvas_call *call, const char *value, size_t size){
+    call->result = NodeInfo(NodeType::STR_LIT, '\"' + std::string(value, size) + '\"');
+}
+
+void canvas_call_error(canvas_call *call, const char *message){
+    call->error = message == nullptr ? "" : message;
+}
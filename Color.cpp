@@ -0,0 +1,187 @@
+#include "headers/Color.hpp"
+#include "headers/Utility.hpp"
+#include "headers/Error.hpp"
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define CANVAS_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+// Helper Functions
+static float clampUnit(float value){
+    return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+}
+
+static float normalizeHue(float hue){
+    if(!std::isfinite(hue)){
+        return 0.0f;
+    }
+
+    hue = std::fmod(hue, 360.0f);
+    if(hue < 0.0f){
+        hue += 360.0f;
+    }
+
+    return hue < 360.0f ? hue : 0.0f;
+}
+
+// One channel of the branch free HSL formula, n is 0 for red, 8 for green and 4 for blue. The SSE2
+// path below performs the same float operations in the same order, so both round identically.
+static std::uint32_t hslChannel(float n, float h, float s, float l){
+    float k = n + h * (1.0f / 30.0f);
+    k = k - 12.0f * static_cast<float>(static_cast<int>(k * (1.0f / 12.0f)));
+    float chroma = s * std::min(l, 1.0f - l);
+    float m = std::max(-1.0f, std::min(std::min(k - 3.0f, 9.0f - k), 1.0f));
+
+    return static_cast<std::uint32_t>((l - chroma * m) * 255.0f + 0.5f);
+}
+
+static std::uint32_t hslScalar(float h, float s, float l, float a){
+    return hslChannel(0.0f, h, s, l) | (hslChannel(8.0f, h, s, l) << 8) | (hslChannel(4.0f, h, s, l) << 16) | (static_cast<std::uint32_t>(a * 255.0f + 0.5f) << 24);
+}
+
+#ifdef CANVAS_X86_KERNELS
+__attribute__((target("sse2"))) static inline __m128i hslChannelSse2(__m128 n, __m128 h, __m128 s, __m128 l){
+    __m128 k = _mm_add_ps(n, _mm_mul_ps(h, _mm_set1_ps(1.0f / 30.0f)));
+    __m128 turns = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(k, _mm_set1_ps(1.0f / 12.0f))));
+    k = _mm_sub_ps(k, _mm_mul_ps(_mm_set1_ps(12.0f), turns));
+    __m128 chroma = _mm_mul_ps(s, _mm_min_ps(l, _mm_sub_ps(_mm_set1_ps(1.0f), l)));
+    __m128 m = _mm_max_ps(_mm_set1_ps(-1.0f), _mm_min_ps(_mm_min_ps(_mm_sub_ps(k, _mm_set1_ps(3.0f)), _mm_sub_ps(_mm_set1_ps(9.0f), k)), _mm_set1_ps(1.0f)));
+    __m128 value = _mm_sub_ps(l, _mm_mul_ps(chroma, m));
+
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+__attribute__((target("sse2"))) static std::size_t hslToColorsSse2(const float *h, const float *s, const float *l, const float *a, std::uint32_t *out, std::size_t count){
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128 hue = _mm_loadu_ps(h + i);
+        __m128 saturation = _mm_loadu_ps(s + i);
+        __m128 lightness = _mm_loadu_ps(l + i);
+        __m128i red = hslChannelSse2(_mm_set1_ps(0.0f), hue, saturation, lightness);
+        __m128i green = hslChannelSse2(_mm_set1_ps(8.0f), hue, saturation, lightness);
+        __m128i blue = hslChannelSse2(_mm_set1_ps(4.0f), hue, saturation, lightness);
+        __m128i alpha = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+
+        __m128i packed = _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)), _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_slli_epi32(alpha, 24)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+
+    return i;
+}
+#endif
+
+std::uint32_t hslToColor(float h, float s, float l, float a){
+    return hslScalar(normalizeHue(h), clampUnit(s), clampUnit(l), clampUnit(a));
+}
+
+void colorToHsl(std::uint32_t color, float &h, float &s, float &l){
+    float r = colorChannel(color, 0) / 255.0f;
+    float g = colorChannel(color, 1) / 255.0f;
+    float b = colorChannel(color, 2) / 255.0f;
+    float high = std::max(r, std::max(g, b));
+    float low = std::min(r, std::min(g, b));
+    float delta = high - low;
+
+    l = (high + low) / 2.0f;
+    if(delta == 0.0f){
+        h = 0.0f;
+        s = 0.0f;
+        return;
+    }
+
+    s = delta / (1.0f - std::fabs(2.0f * l - 1.0f));
+    if(high == r){
+        h = 60.0f * std::fmod((g - b) / delta + 6.0f, 6.0f);
+    }else if(high == g){
+        h = 60.0f * ((b - r) / delta + 2.0f);
+    }else{
+        h = 60.0f * ((r - g) / delta + 4.0f);
+    }
+}
+
+std::string colorToHex(std::uint32_t color){
+    static const char digits[] = "0123456789abcdef";
+    std::string hex = "#";
+    for(int channel = 0; channel < 4; ++channel){
+        hex.push_back(digits[colorChannel(color, channel) >> 4]);
+        hex.push_back(digits[colorChannel(color, channel) & 0xF]);
+    }
+
+    return hex;
+}
+
+// The inputs are copied and sanitised first so the kernels can assume hue in [0, 360) and the
+// other components in [0, 1].
+void hslToColors(const float *h, const float *s, const float *l, const float *a, std::uint32_t *out, std::size_t count){
+    std::vector<float> hue(h, h + count), saturation(s, s + count), lightness(l, l + count), alpha(a, a + count);
+    for(std::size_t i = 0; i < count; ++i){
+        hue[i] = normalizeHue(hue[i]);
+        saturation[i] = clampUnit(saturation[i]);
+        lightness[i] = clampUnit(lightness[i]);
+        alpha[i] = clampUnit(alpha[i]);
+    }
+
+    std::size_t i = 0;
+#ifdef CANVAS_X86_KERNELS
+    static const bool hasSse2 = __builtin_cpu_supports("sse2");
+    if(hasSse2){
+        i = hslToColorsSse2(hue.data(), saturation.data(), lightness.data(), alpha.data(), out, count);
+    }
+#endif
+    for(; i < count; ++i){
+        out[i] = hslScalar(hue[i], saturation[i], lightness[i], alpha[i]);
+    }
+}
+
+void gradientColors(std::uint32_t from, std::uint32_t to, std::uint32_t *out, std::size_t count){
+    for(std::size_t i = 0; i < count; ++i){
+        out[i] = gradientColorAt(from, to, i, count);
+    }
+}
+
+// Colours are colour values, "#RRGGBB"/"#RRGGBBAA" strings or [r, g, b] / [r, g, b, a] lists.
+// Parsed strings are cached per thread so repeated literals are only converted once.
+std::uint32_t parseColor(const Data &data){
+    if(const auto *intPtr = std::get_if<std::int32_t>(&data)){
+        return static_cast<std::uint32_t>(*intPtr);
+    }else if(const auto *strPtr = std::get_if<std::string>(&data)){
+        thread_local std::unordered_map<std::string, std::uint32_t> parsedColors;
+        auto cached = parsedColors.find(*strPtr);
+        if(cached != parsedColors.end()){
+            return cached->second;
+        }
+
+        std::string hex = stripStr(*strPtr);
+        if(!hex.empty() && hex[0] == '#'){
+            hex.erase(0, 1);
+        }
+
+        if((hex.size() == 6 || hex.size() == 8) && hex.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos){
+            std::uint32_t value = std::stoul(hex, nullptr, 16);
+            std::uint32_t color = hex.size() == 6 ? packColor(value >> 16, value >> 8, value) : packColor(value >> 24, value >> 16, value >> 8, value);
+
+            if(parsedColors.size() >= 4096){
+                parsedColors.clear();
+            }
+            parsedColors.emplace(*strPtr, color);
+
+            return color;
+        }
+    }else if(const auto *refPtr = std::get_if<Ref>(&data)){
+        if(*refPtr && refPtr->get()->kind == HeapObjectType::LIST){
+            std::vector<Data> &elements = refPtr->as<ListObject>()->elements;
+            if(elements.size() == 3 || elements.size() == 4){
+                std::uint8_t channels[4] = {0, 0, 0, 255};
+                for(std::size_t i = 0; i < elements.size(); ++i){
+                    channels[i] = toChannel(variantAsNum(elements[i]));
+                }
+
+                return packColor(channels[0], channels[1], channels[2], channels[3]);
+            }
+        }
+    }
+
+    throw ParserException("~Error~ Invalid colour \'" + variantAsStr(const_cast<Data&>(data)) + "\'.");
+}
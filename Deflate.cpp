@@ -0,0 +1,741 @@
+#include "headers/Deflate.hpp"
+#include "headers/Error.hpp"
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+// LZ77 parameters, a hash chain over 3 byte prefixes that gives up after MAX_CHAIN candidates.
+const int HASH_BITS = 15;
+const std::size_t MIN_MATCH = 3;
+const std::size_t MAX_MATCH = 258;
+const std::size_t NICE_MATCH = 128;
+const int MAX_CHAIN = 32;
+const std::size_t BLOCK_TOKENS = 1 << 15;
+
+static const std::uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const std::uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const std::uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const std::uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const std::uint8_t codeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// A literal when distance is 0, otherwise a back reference.
+struct LzToken{
+    // Variables
+    std::uint16_t length;
+    std::uint16_t distance;
+};
+
+// Deflate packs bits starting from the least significant one.
+struct DeflateBitWriter{
+    // Variables
+    std::vector<std::uint8_t> &out;
+    std::uint64_t bits = 0;
+    int count = 0;
+
+    // Functions
+    void put(std::uint32_t value, int size){
+        bits |= static_cast<std::uint64_t>(value) << count;
+        count += size;
+        while(count >= 8){
+            out.push_back(static_cast<std::uint8_t>(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void align(){
+        if(count > 0){
+            out.push_back(static_cast<std::uint8_t>(bits));
+        }
+        bits = 0;
+        count = 0;
+    }
+};
+
+// Helper Functions
+static int lengthIndex(std::size_t length){
+    static const std::vector<std::uint8_t> indices = [](){
+        std::vector<std::uint8_t> table(MAX_MATCH + 1);
+        for(int index = 0; index < 29; ++index){
+            std::size_t last = index == 28 ? MAX_MATCH : lengthBase[index + 1] - 1u;
+            for(std::size_t length = lengthBase[index]; length <= last; ++length){
+                table[length] = index;
+            }
+        }
+        return table;
+    }();
+    return indices[length];
+}
+
+static int distanceIndex(std::size_t distance){
+    return static_cast<int>(std::upper_bound(distanceBase, distanceBase + 30, distance) - distanceBase) - 1;
+}
+
+// Huffman code lengths no longer than limit. Frequencies are halved until the tree fits, which
+// costs a little compression on pathological inputs but always terminates.
+static void buildLengths(const std::uint32_t *freq, int count, int limit, std::uint8_t *lengths){
+    std::vector<std::uint64_t> weights(freq, freq + count);
+    while(true){
+        using Node = std::pair<std::uint64_t, int>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        std::vector<int> parents(count * 2, -1);
+        for(int i = 0; i < count; ++i){
+            if(weights[i]){
+                queue.emplace(weights[i], i);
+            }
+        }
+
+        int next = count;
+        while(queue.size() > 1){
+            Node first = queue.top();
+            queue.pop();
+            Node second = queue.top();
+            queue.pop();
+            parents[first.second] = next;
+            parents[second.second] = next;
+            queue.emplace(first.first + second.first, next++);
+        }
+
+        int longest = 0;
+        for(int i = 0; i < count; ++i){
+            int depth = 0;
+            if(weights[i]){
+                for(int node = i; parents[node] != -1; node = parents[node]){
+                    ++depth;
+                }
+            }
+            lengths[i] = depth;
+            longest = std::max(longest, depth);
+        }
+
+        if(longest <= limit){
+            return;
+        }
+
+        for(auto &e : weights){
+            if(e){
+                e = (e >> 1) | 1;
+            }
+        }
+    }
+}
+
+// Canonical codes, bit reversed so they can be written least significant bit first.
+static void buildCodes(const std::uint8_t *lengths, int count, std::uint16_t *codes){
+    int lengthCounts[16] = {0};
+    for(int i = 0; i < count; ++i){
+        ++lengthCounts[lengths[i]];
+    }
+    lengthCounts[0] = 0;
+
+    int nextCodes[16] = {0};
+    int code = 0;
+    for(int bits = 1; bits < 16; ++bits){
+        code = (code + lengthCounts[bits - 1]) << 1;
+        nextCodes[bits] = code;
+    }
+
+    for(int i = 0; i < count; ++i){
+        int value = lengths[i] ? nextCodes[lengths[i]]++ : 0;
+        int reversed = 0;
+        for(int bit = 0; bit < lengths[i]; ++bit){
+            reversed = (reversed << 1) | ((value >> bit) & 1);
+        }
+        codes[i] = reversed;
+    }
+}
+
+// Inflaters reject incomplete code sets, a tree with at least two symbols is always complete.
+static void ensureTwoSymbols(std::uint32_t *freq, int count){
+    int used = static_cast<int>(std::count_if(freq, freq + count, [](std::uint32_t e){ return e != 0; }));
+    for(int i = 0; used < 2 && i < count; ++i){
+        if(!freq[i]){
+            freq[i] = 1;
+            ++used;
+        }
+    }
+}
+
+static void writeTokens(DeflateBitWriter &writer, const std::vector<LzToken> &tokens, const std::uint8_t *litLengths, const std::uint16_t *litCodes, const std::uint8_t *distLengths, const std::uint16_t *distCodes){
+    for(const auto &e : tokens){
+        if(e.distance == 0){
+            writer.put(litCodes[e.length], litLengths[e.length]);
+            continue;
+        }
+
+        int length = lengthIndex(e.length);
+        writer.put(litCodes[257 + length], litLengths[257 + length]);
+        writer.put(e.length - lengthBase[length], lengthExtra[length]);
+
+        int distance = distanceIndex(e.distance);
+        writer.put(distCodes[distance], distLengths[distance]);
+        writer.put(e.distance - distanceBase[distance], distanceExtra[distance]);
+    }
+    writer.put(litCodes[256], litLengths[256]);
+}
+
+// Writes one block as stored, fixed or dynamic Huffman, whichever is smallest.
+static void writeBlock(DeflateBitWriter &writer, const std::vector<LzToken> &tokens, const std::uint8_t *raw, std::size_t rawSize, bool isFinal){
+    std::uint32_t litFreq[286] = {0};
+    std::uint32_t distFreq[30] = {0};
+    std::uint64_t extraBits = 0;
+    for(const auto &e : tokens){
+        if(e.distance == 0){
+            ++litFreq[e.length];
+        }else{
+            int length = lengthIndex(e.length);
+            int distance = distanceIndex(e.distance);
+            ++litFreq[257 + length];
+            ++distFreq[distance];
+            extraBits += lengthExtra[length] + distanceExtra[distance];
+        }
+    }
+    litFreq[256] = 1;
+
+    static std::uint8_t fixedLitLengths[288], fixedDistLengths[30];
+    static std::uint16_t fixedLitCodes[288], fixedDistCodes[30];
+    static const bool isFixedReady = [](){
+        std::fill(fixedLitLengths, fixedLitLengths + 144, 8);
+        std::fill(fixedLitLengths + 144, fixedLitLengths + 256, 9);
+        std::fill(fixedLitLengths + 256, fixedLitLengths + 280, 7);
+        std::fill(fixedLitLengths + 280, fixedLitLengths + 288, 8);
+        std::fill(fixedDistLengths, fixedDistLengths + 30, 5);
+        buildCodes(fixedLitLengths, 288, fixedLitCodes);
+        buildCodes(fixedDistLengths, 30, fixedDistCodes);
+        return true;
+    }();
+    (void)isFixedReady;
+
+    std::uint64_t fixedCost = 3 + extraBits;
+    std::uint64_t dynamicCost = 3 + 14 + extraBits;
+    for(int i = 0; i < 286; ++i){
+        fixedCost += static_cast<std::uint64_t>(litFreq[i]) * fixedLitLengths[i];
+    }
+    for(int i = 0; i < 30; ++i){
+        fixedCost += static_cast<std::uint64_t>(distFreq[i]) * fixedDistLengths[i];
+    }
+
+    // Dynamic trees, the dummy symbols only exist to keep the code sets complete.
+    std::uint32_t litTreeFreq[286], distTreeFreq[30];
+    std::copy(litFreq, litFreq + 286, litTreeFreq);
+    std::copy(distFreq, distFreq + 30, distTreeFreq);
+    ensureTwoSymbols(litTreeFreq, 286);
+    ensureTwoSymbols(distTreeFreq, 30);
+
+    std::uint8_t litLengths[286], distLengths[30];
+    buildLengths(litTreeFreq, 286, 15, litLengths);
+    buildLengths(distTreeFreq, 30, 15, distLengths);
+    for(int i = 0; i < 286; ++i){
+        dynamicCost += static_cast<std::uint64_t>(litFreq[i]) * litLengths[i];
+    }
+    for(int i = 0; i < 30; ++i){
+        dynamicCost += static_cast<std::uint64_t>(distFreq[i]) * distLengths[i];
+    }
+
+    int litCount = 286;
+    while(litCount > 257 && litLengths[litCount - 1] == 0){
+        --litCount;
+    }
+    int distCount = 30;
+    while(distCount > 1 && distLengths[distCount - 1] == 0){
+        --distCount;
+    }
+
+    // Run length encoding of both length tables, 16 repeats the previous length, 17 and 18 zeros.
+    std::vector<std::uint8_t> allLengths(litLengths, litLengths + litCount);
+    allLengths.insert(allLengths.end(), distLengths, distLengths + distCount);
+    std::vector<std::pair<std::uint8_t, std::uint8_t>> runs;
+    for(std::size_t i = 0; i < allLengths.size();){
+        std::uint8_t value = allLengths[i];
+        std::size_t run = 1;
+        while(i + run < allLengths.size() && allLengths[i + run] == value){
+            ++run;
+        }
+
+        std::size_t left = run;
+        if(value == 0){
+            while(left >= 11){
+                std::size_t repeat = std::min<std::size_t>(left, 138);
+                runs.emplace_back(18, repeat - 11);
+                left -= repeat;
+            }
+            if(left >= 3){
+                runs.emplace_back(17, left - 3);
+                left = 0;
+            }
+        }else{
+            runs.emplace_back(value, 0);
+            --left;
+            while(left >= 3){
+                std::size_t repeat = std::min<std::size_t>(left, 6);
+                runs.emplace_back(16, repeat - 3);
+                left -= repeat;
+            }
+        }
+
+        for(; left > 0; --left){
+            runs.emplace_back(value, 0);
+        }
+        i += run;
+    }
+
+    std::uint32_t codeLengthFreq[19] = {0};
+    for(const auto &e : runs){
+        ++codeLengthFreq[e.first];
+    }
+    ensureTwoSymbols(codeLengthFreq, 19);
+
+    std::uint8_t codeLengthLengths[19];
+    std::uint16_t codeLengthCodes[19];
+    buildLengths(codeLengthFreq, 19, 7, codeLengthLengths);
+    buildCodes(codeLengthLengths, 19, codeLengthCodes);
+
+    int codeLengthCount = 19;
+    while(codeLengthCount > 4 && codeLengthLengths[codeLengthOrder[codeLengthCount - 1]] == 0){
+        --codeLengthCount;
+    }
+
+    dynamicCost += 3 * codeLengthCount;
+    for(const auto &e : runs){
+        dynamicCost += codeLengthLengths[e.first] + (e.first == 16 ? 2 : e.first == 17 ? 3 : e.first == 18 ? 7 : 0);
+    }
+
+    std::size_t storedChunks = std::max<std::size_t>(1, (rawSize + 65534) / 65535);
+    std::uint64_t storedCost = storedChunks * (3 + 7 + 32) + rawSize * 8;
+
+    if(storedCost <= fixedCost && storedCost <= dynamicCost){
+        for(std::size_t chunk = 0; chunk < storedChunks; ++chunk){
+            std::size_t offset = chunk * 65535;
+            std::size_t size = std::min<std::size_t>(65535, rawSize - offset);
+            writer.put(isFinal && chunk + 1 == storedChunks, 1);
+            writer.put(0, 2);
+            writer.align();
+            writer.put(size, 16);
+            writer.put(~size & 0xFFFF, 16);
+            writer.out.insert(writer.out.end(), raw + offset, raw + offset + size);
+        }
+    }else if(fixedCost <= dynamicCost){
+        writer.put(isFinal, 1);
+        writer.put(1, 2);
+        writeTokens(writer, tokens, fixedLitLengths, fixedLitCodes, fixedDistLengths, fixedDistCodes);
+    }else{
+        std::uint16_t litCodes[286], distCodes[30];
+        buildCodes(litLengths, 286, litCodes);
+        buildCodes(distLengths, 30, distCodes);
+
+        writer.put(isFinal, 1);
+        writer.put(2, 2);
+        writer.put(litCount - 257, 5);
+        writer.put(distCount - 1, 5);
+        writer.put(codeLengthCount - 4, 4);
+        for(int i = 0; i < codeLengthCount; ++i){
+            writer.put(codeLengthLengths[codeLengthOrder[i]], 3);
+        }
+        for(const auto &e : runs){
+            writer.put(codeLengthCodes[e.first], codeLengthLengths[e.first]);
+            if(e.first >= 16){
+                writer.put(e.second, e.first == 16 ? 2 : e.first == 17 ? 3 : 7);
+            }
+        }
+        writeTokens(writer, tokens, litLengths, litCodes, distLengths, distCodes);
+    }
+}
+
+void deflateStrip(const std::uint8_t *data, std::size_t start, std::size_t end, bool isFinal, std::vector<std::uint8_t> &out){
+    const std::size_t historyStart = start > DEFLATE_WINDOW ? start - DEFLATE_WINDOW : 0;
+    std::vector<std::int64_t> heads(std::size_t(1) << HASH_BITS, -1);
+    std::vector<std::int64_t> previous(DEFLATE_WINDOW, -1);
+
+    auto hashAt = [data](std::size_t i){
+        std::uint32_t prefix = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+        return (prefix * 2654435761u) >> (32 - HASH_BITS);
+    };
+    auto insert = [&](std::size_t i){
+        if(i + 2 < end){
+            std::uint32_t hash = hashAt(i);
+            previous[i % DEFLATE_WINDOW] = heads[hash];
+            heads[hash] = i;
+        }
+    };
+
+    for(std::size_t i = historyStart; i < start; ++i){
+        insert(i);
+    }
+
+    DeflateBitWriter writer{out};
+    std::vector<LzToken> tokens;
+    tokens.reserve(BLOCK_TOKENS);
+    std::size_t blockStart = start;
+
+    std::size_t i = start;
+    while(i < end){
+        std::size_t bestLength = 0;
+        std::size_t bestDistance = 0;
+        if(i + MIN_MATCH <= end){
+            std::size_t limit = std::min(MAX_MATCH, end - i);
+            std::int64_t candidate = heads[hashAt(i)];
+            for(int chain = 0; chain < MAX_CHAIN && candidate >= static_cast<std::int64_t>(historyStart) && i - candidate <= DEFLATE_WINDOW; ++chain){
+                const std::uint8_t *match = data + candidate;
+                const std::uint8_t *current = data + i;
+                if(match[bestLength] == current[bestLength]){
+                    std::size_t length = 0;
+                    while(length < limit && match[length] == current[length]){
+                        ++length;
+                    }
+
+                    if(length > bestLength){
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                        if(length >= NICE_MATCH || length == limit){
+                            break;
+                        }
+                    }
+                }
+
+                std::int64_t next = previous[candidate % DEFLATE_WINDOW];
+                if(next >= candidate){
+                    break;
+                }
+                candidate = next;
+            }
+        }
+
+        if(bestLength >= MIN_MATCH){
+            tokens.push_back(LzToken{static_cast<std::uint16_t>(bestLength), static_cast<std::uint16_t>(bestDistance)});
+            for(std::size_t k = 0; k < bestLength; ++k){
+                insert(i++);
+            }
+        }else{
+            tokens.push_back(LzToken{data[i], 0});
+            insert(i++);
+        }
+
+        if(tokens.size() >= BLOCK_TOKENS){
+            writeBlock(writer, tokens, data + blockStart, i - blockStart, false);
+            tokens.clear();
+            blockStart = i;
+        }
+    }
+
+    if(!tokens.empty() || isFinal){
+        writeBlock(writer, tokens, data + blockStart, end - blockStart, isFinal);
+    }
+
+    if(!isFinal){
+        writer.put(0, 3);
+        writer.align();
+        writer.put(0x0000, 16);
+        writer.put(0xFFFF, 16);
+    }else{
+        writer.align();
+    }
+}
+
+// Inflate reads bits least significant first, refilling 64 bits at a time.
+struct InflateReader{
+    // Variables
+    const std::uint8_t *data;
+    std::size_t size;
+    std::size_t position = 0;
+    std::uint64_t bits = 0;
+    int count = 0;
+
+    // Functions
+    void refill(){
+        while(count <= 56 && position < size){
+            bits |= static_cast<std::uint64_t>(data[position++]) << count;
+            count += 8;
+        }
+    }
+
+    std::uint32_t take(int size){
+        if(count < size){
+            refill();
+            if(count < size){
+                throw ParserException("~Error~ Truncated deflate stream.");
+            }
+        }
+
+        std::uint32_t value = static_cast<std::uint32_t>(bits & ((std::uint64_t(1) << size) - 1));
+        bits >>= size;
+        count -= size;
+        return value;
+    }
+
+    void align(){
+        int skip = count % 8;
+        bits >>= skip;
+        count -= skip;
+    }
+};
+
+// Canonical Huffman decoding, codes up to FAST_BITS long resolve with one table lookup.
+struct HuffmanDecoder{
+    static const int FAST_BITS = 10;
+
+    // Variables
+    std::uint16_t counts[16];
+    std::uint16_t symbols[288];
+    std::uint16_t fast[1 << FAST_BITS];
+
+    // Functions
+    void build(const std::uint8_t *lengths, int count){
+        std::fill(counts, counts + 16, 0);
+        std::fill(fast, fast + (1 << FAST_BITS), 0);
+        for(int i = 0; i < count; ++i){
+            ++counts[lengths[i]];
+        }
+        counts[0] = 0;
+
+        int left = 1;
+        for(int bits = 1; bits < 16; ++bits){
+            left = (left << 1) - counts[bits];
+            if(left < 0){
+                throw ParserException("~Error~ Invalid Huffman code in deflate stream.");
+            }
+        }
+
+        std::uint16_t offsets[16] = {0};
+        for(int bits = 1; bits < 15; ++bits){
+            offsets[bits + 1] = offsets[bits] + counts[bits];
+        }
+
+        int nextCodes[16] = {0};
+        int code = 0;
+        for(int bits = 1; bits < 16; ++bits){
+            code = (code + counts[bits - 1]) << 1;
+            nextCodes[bits] = code;
+        }
+
+        for(int i = 0; i < count; ++i){
+            int length = lengths[i];
+            if(length == 0){
+                continue;
+            }
+
+            symbols[offsets[length]++] = i;
+            int value = nextCodes[length]++;
+            if(length <= FAST_BITS){
+                int reversed = 0;
+                for(int bit = 0; bit < length; ++bit){
+                    reversed = (reversed << 1) | ((value >> bit) & 1);
+                }
+                for(int entry = reversed; entry < (1 << FAST_BITS); entry += 1 << length){
+                    fast[entry] = static_cast<std::uint16_t>((i << 4) | length);
+                }
+            }
+        }
+    }
+
+    int decode(InflateReader &reader) const{
+        if(reader.count < 15){
+            reader.refill();
+        }
+
+        std::uint16_t entry = fast[reader.bits & ((1 << FAST_BITS) - 1)];
+        if(entry != 0 && (entry & 0xF) <= reader.count){
+            reader.bits >>= entry & 0xF;
+            reader.count -= entry & 0xF;
+            return entry >> 4;
+        }
+
+        // Longer codes are walked one bit at a time.
+        int code = 0, first = 0, index = 0;
+        for(int length = 1; length < 16; ++length){
+            code |= reader.take(1);
+            int count = counts[length];
+            if(code - first < count){
+                return symbols[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+
+        throw ParserException("~Error~ Invalid Huffman code in deflate stream.");
+    }
+};
+
+static void checkLimit(std::size_t size, std::size_t limit){
+    if(size > limit){
+        throw ParserException("~Error~ Deflate stream is larger than expected.");
+    }
+}
+
+static void inflateBlock(InflateReader &reader, const HuffmanDecoder &literals, const HuffmanDecoder &distances, std::vector<std::uint8_t> &out, std::size_t outLimit){
+    while(true){
+        int symbol = literals.decode(reader);
+        if(symbol < 256){
+            checkLimit(out.size() + 1, outLimit);
+            out.push_back(symbol);
+            continue;
+        }else if(symbol == 256){
+            return;
+        }else if(symbol > 285){
+            throw ParserException("~Error~ Invalid length in deflate stream.");
+        }
+
+        std::size_t length = lengthBase[symbol - 257] + reader.take(lengthExtra[symbol - 257]);
+        int distanceSymbol = distances.decode(reader);
+        if(distanceSymbol >= 30){
+            throw ParserException("~Error~ Invalid distance in deflate stream.");
+        }
+
+        std::size_t distance = distanceBase[distanceSymbol] + reader.take(distanceExtra[distanceSymbol]);
+        if(distance > out.size()){
+            throw ParserException("~Error~ Invalid distance in deflate stream.");
+        }
+
+        checkLimit(out.size() + length, outLimit);
+
+        // Copies may overlap their own output, so they go byte by byte.
+        std::size_t from = out.size() - distance;
+        for(std::size_t i = 0; i < length; ++i){
+            out.push_back(out[from + i]);
+        }
+    }
+}
+
+void inflateZlib(const std::uint8_t *data, std::size_t size, std::vector<std::uint8_t> &out, std::size_t limit){
+    if(size < 6 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)){
+        throw ParserException("~Error~ Invalid zlib stream.");
+    }
+
+    InflateReader reader{data + 2, size - 2};
+    std::size_t outStart = out.size();
+    std::size_t outLimit = limit > SIZE_MAX - outStart ? SIZE_MAX : outStart + limit;
+    HuffmanDecoder literals, distances;
+    bool isFinal = false;
+    while(!isFinal){
+        isFinal = reader.take(1);
+        int type = reader.take(2);
+        if(type == 0){
+            reader.align();
+            std::uint32_t length = reader.take(16);
+            if((reader.take(16) ^ 0xFFFF) != length){
+                throw ParserException("~Error~ Invalid stored block in deflate stream.");
+            }
+            checkLimit(out.size() + length, outLimit);
+            for(std::uint32_t i = 0; i < length; ++i){
+                out.push_back(reader.take(8));
+            }
+        }else if(type == 1){
+            static const std::vector<std::uint8_t> fixedLengths = [](){
+                std::vector<std::uint8_t> lengths(320);
+                std::fill(lengths.begin(), lengths.begin() + 144, 8);
+                std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+                std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+                std::fill(lengths.begin() + 280, lengths.begin() + 288, 8);
+                std::fill(lengths.begin() + 288, lengths.end(), 5);
+                return lengths;
+            }();
+            literals.build(fixedLengths.data(), 288);
+            distances.build(fixedLengths.data() + 288, 30);
+            inflateBlock(reader, literals, distances, out, outLimit);
+        }else if(type == 2){
+            int litCount = reader.take(5) + 257;
+            int distCount = reader.take(5) + 1;
+            int codeLengthCount = reader.take(4) + 4;
+            if(litCount > 286 || distCount > 30){
+                throw ParserException("~Error~ Invalid dynamic block in deflate stream.");
+            }
+
+            std::uint8_t codeLengthLengths[19] = {0};
+            for(int i = 0; i < codeLengthCount; ++i){
+                codeLengthLengths[codeLengthOrder[i]] = reader.take(3);
+            }
+            HuffmanDecoder codeLengths;
+            codeLengths.build(codeLengthLengths, 19);
+
+            std::uint8_t lengths[316] = {0};
+            for(int i = 0; i < litCount + distCount;){
+                int symbol = codeLengths.decode(reader);
+                if(symbol < 16){
+                    lengths[i++] = symbol;
+                    continue;
+                }
+
+                int repeat = symbol == 16 ? 3 + reader.take(2) : symbol == 17 ? 3 + reader.take(3) : 11 + reader.take(7);
+                if((symbol == 16 && i == 0) || i + repeat > litCount + distCount){
+                    throw ParserException("~Error~ Invalid dynamic block in deflate stream.");
+                }
+
+                std::uint8_t value = symbol == 16 ? lengths[i - 1] : 0;
+                std::fill(lengths + i, lengths + i + repeat, value);
+                i += repeat;
+            }
+
+            literals.build(lengths, litCount);
+            distances.build(lengths + litCount, distCount);
+            inflateBlock(reader, literals, distances, out, outLimit);
+        }else{
+            throw ParserException("~Error~ Invalid block type in deflate stream.");
+        }
+    }
+
+    reader.align();
+    std::uint32_t expected = 0;
+    for(int i = 0; i < 4; ++i){
+        expected = (expected << 8) | reader.take(8);
+    }
+    if(adler32(out.data() + outStart, out.size() - outStart) != expected){
+        throw ParserException("~Error~ Checksum mismatch in zlib stream.");
+    }
+}
+
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size, std::uint32_t crc){
+    static const std::vector<std::uint32_t> table = [](){
+        std::vector<std::uint32_t> entries(256);
+        for(std::uint32_t i = 0; i < 256; ++i){
+            std::uint32_t value = i;
+            for(int bit = 0; bit < 8; ++bit){
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+
+    crc = ~crc;
+    for(std::size_t i = 0; i < size; ++i){
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+std::uint32_t adler32(const std::uint8_t *data, std::size_t size, std::uint32_t adler){
+    const std::uint32_t base = 65521;
+    std::uint32_t a = adler & 0xFFFF;
+    std::uint32_t b = adler >> 16;
+    while(size > 0){
+        // 5552 bytes is the most that can be summed before b overflows 32 bits.
+        std::size_t block = std::min<std::size_t>(size, 5552);
+        for(std::size_t i = 0; i < block; ++i){
+            a += data[i];
+            b += a;
+        }
+
+        a %= base;
+        b %= base;
+        data += block;
+        size -= block;
+    }
+
+    return a | (b << 16);
+}
+
+// The checksum of two consecutive ranges from their own checksums, so strips can be summed apart.
+std::uint32_t adler32Combine(std::uint32_t first, std::uint32_t second, std::size_t secondSize){
+    const std::uint64_t base = 65521;
+    std::uint64_t remainder = secondSize % base;
+    std::uint64_t a = first & 0xFFFF;
+    std::uint64_t b = (remainder * a) % base;
+
+    a += (second & 0xFFFF) + base - 1;
+    b += (first >> 16) + (second >> 16) + base - remainder;
+    a %= base;
+    b %= base;
+
+    return static_cast<std::uint32_t>(a | (b << 16));
+}
@@ -26,6 +26,17 @@ const char* ParserException::what() const noexcept{
     return this->m_msg.c_str();
 }
 
+/* LimitError Struct */
+// Constructor & Destructor
+LimitError::LimitError(std::string msg){
+    this->m_msg = "~Limit Error~ " + msg;
+}
+
+// Functions
+const char* LimitError::what() const noexcept{
+    return this->m_msg.c_str();
+}
+
 /* SyntaxError Struct */
 // Constructor & Destructor
 SyntaxError::SyntaxError(std::string msg){
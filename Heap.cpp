@@ -0,0 +1,470 @@
+#include "headers/Heap.hpp"
+#include "headers/Error.hpp"
+
+/* HeapObject Class */
+// Constructor & Destructor
+HeapObject::HeapObject(HeapObjectType kind) : kind(kind){}
+
+// Functions
+bool HeapObject::isContainer() const{
+    return kind == HeapObjectType::LIST || kind == HeapObjectType::CLOSURE || kind == HeapObjectType::UPVALUE;
+}
+
+void HeapObject::forEachRef(const std::function<void(HeapObject*)>&){}
+void HeapObject::clearRefs(){}
+void HeapObject::dropRefs(){}
+
+/* Ref Class */
+// Functions
+Ref &Ref::operator=(const Ref &other){
+    if(m_object != other.m_object){
+        HeapObject *previous = m_object;
+        m_object = other.m_object;
+        incRef();
+
+        Ref released;
+        released.m_object = previous;
+    }
+
+    return *this;
+}
+
+Ref &Ref::operator=(Ref &&other) noexcept{
+    if(this != &other){
+        Ref released;
+        released.m_object = m_object;
+        m_object = other.m_object;
+        other.m_object = nullptr;
+    }
+
+    return *this;
+}
+
+HeapObject *Ref::release(){
+    HeapObject *object = m_object;
+    m_object = nullptr;
+
+    return object;
+}
+
+bool operator==(const Ref &left, const Ref &right){ return left.get() == right.get(); }
+bool operator!=(const Ref &left, const Ref &right){ return left.get() != right.get(); }
+bool operator<(const Ref &left, const Ref &right){ return left.get() < right.get(); }
+bool operator>(const Ref &left, const Ref &right){ return left.get() > right.get(); }
+bool operator<=(const Ref &left, const Ref &right){ return left.get() <= right.get(); }
+bool operator>=(const Ref &left, const Ref &right){ return left.get() >= right.get(); }
+
+std::ostream &operator<<(std::ostream &stream, const Ref &ref){
+    return stream << "(_OBJ)" << reinterpret_cast<std::uintptr_t>(ref.get());
+}
+
+/* ListObject Struct */
+// Constructor & Destructor
+ListObject::ListObject(std::vector<Data> elements) : HeapObject(HeapObjectType::LIST), elements(std::move(elements)){}
+
+// Functions
+std::size_t ListObject::byteSize() const{
+    std::size_t bytes = byteSizeFor(elements.capacity());
+    for(auto &e : elements){
+        if(const auto *strPtr = std::get_if<std::string>(&e)){
+            bytes += strPtr->capacity();
+        }
+    }
+
+    return bytes;
+}
+
+std::size_t ListObject::byteSizeFor(std::size_t count){
+    return sizeof(ListObject) + count * sizeof(Data);
+}
+
+void ListObject::forEachRef(const std::function<void(HeapObject*)> &visitor){
+    for(auto &e : elements){
+        if(const auto *refPtr = std::get_if<Ref>(&e)){
+            if(*refPtr){
+                visitor(refPtr->get());
+            }
+        }
+    }
+}
+
+void ListObject::clearRefs(){
+    std::vector<Data>().swap(elements);
+}
+
+void ListObject::dropRefs(){
+    for(auto &e : elements){
+        if(auto *refPtr = std::get_if<Ref>(&e)){
+            refPtr->release();
+        }
+    }
+    elements.clear();
+}
+
+/* UpvalueObject Struct */
+// Constructor & Destructor
+UpvalueObject::UpvalueObject(Data *slot) : HeapObject(HeapObjectType::UPVALUE), slot(slot){}
+
+// Functions
+void UpvalueObject::close(){
+    closed = std::move(*slot);
+    slot = &closed;
+}
+
+std::size_t UpvalueObject::byteSize() const{
+    return sizeof(UpvalueObject);
+}
+
+void UpvalueObject::forEachRef(const std::function<void(HeapObject*)> &visitor){
+    if(slot == &closed){
+        if(const auto *refPtr = std::get_if<Ref>(&closed)){
+            if(*refPtr){
+                visitor(refPtr->get());
+            }
+        }
+    }
+}
+
+void UpvalueObject::clearRefs(){
+    closed = 0;
+}
+
+void UpvalueObject::dropRefs(){
+    if(auto *refPtr = std::get_if<Ref>(&closed)){
+        refPtr->release();
+    }
+    closed = 0;
+}
+
+/* ClosureObject Struct */
+// Constructor & Destructor
+ClosureObject::ClosureObject(AbstractNode *node, std::vector<std::pair<std::string, Ref>> upvalues, std::weak_ptr<SymbolTable> definitionScope)
+    : HeapObject(HeapObjectType::CLOSURE), node(node), upvalues(std::move(upvalues)), definitionScope(std::move(definitionScope)){}
+
+// Functions
+std::size_t ClosureObject::byteSize() const{
+    std::size_t bytes = sizeof(ClosureObject) + upvalues.capacity() * sizeof(std::pair<std::string, Ref>);
+    for(auto &e : upvalues){
+        bytes += e.first.capacity();
+    }
+
+    return bytes;
+}
+
+void ClosureObject::forEachRef(const std::function<void(HeapObject*)> &visitor){
+    for(auto &e : upvalues){
+        visitor(e.second.get());
+    }
+}
+
+void ClosureObject::clearRefs(){
+    std::vector<std::pair<std::string, Ref>>().swap(upvalues);
+}
+
+void ClosureObject::dropRefs(){
+    for(auto &e : upvalues){
+        e.second.release();
+    }
+    upvalues.clear();
+}
+
+/* Heap Class */
+// The heap counts references and breaks cycles with synchronous trial deletion (Bacon & Rajan).
+// Objects whose count drops without reaching zero are buffered as possible cycle roots, and the
+// buffer is scanned on allocation once it grows past the threshold or the heap limit is reached.
+// Constructor & Destructor
+Heap::Heap() : m_limit(0), m_collectThreshold(4096){}
+
+Heap::~Heap(){
+    collect();
+    if(m_account != nullptr){
+        m_account->fetch_sub(m_stats.liveBytes);
+    }
+}
+
+// Functions
+Ref Heap::manage(HeapObject *object){
+    object->heap = this;
+    object->size = object->byteSize();
+
+    if(m_roots.size() >= m_collectThreshold){
+        collect();
+    }
+
+    if(!fits(object->size)){
+        object->heap = nullptr;
+        delete object;
+        throw LimitError("Heap limit of " + std::to_string(m_limit) + " bytes exceeded.");
+    }
+
+    ++m_stats.liveObjects;
+    ++m_stats.totalAllocations;
+    addBytes(object->size);
+    m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.liveBytes);
+
+    return Ref(object);
+}
+
+// Objects owning large buffers check their size before they are built, so running out of heap is
+// a LimitError instead of a failed allocation.
+void Heap::reserve(std::size_t bytes){
+    if(!fits(bytes)){
+        throw LimitError("Heap limit of " + std::to_string(m_limit) + " bytes exceeded.");
+    }
+}
+
+bool Heap::fits(std::size_t bytes){
+    if(m_limit == 0 || usedBytes() + bytes <= m_limit){
+        return true;
+    }
+
+    collect();
+    return usedBytes() + bytes <= m_limit;
+}
+
+std::size_t Heap::usedBytes() const{
+    return m_account != nullptr ? m_account->load() : m_stats.liveBytes;
+}
+
+void Heap::addBytes(std::size_t bytes){
+    m_stats.liveBytes += bytes;
+    if(m_account != nullptr){
+        m_account->fetch_add(bytes);
+    }
+}
+
+void Heap::removeBytes(std::size_t bytes){
+    m_stats.liveBytes -= bytes;
+    if(m_account != nullptr){
+        m_account->fetch_sub(bytes);
+    }
+}
+
+void Heap::free(HeapObject *object){
+    --m_stats.liveObjects;
+    ++m_stats.totalFrees;
+    removeBytes(object->size);
+
+    delete object;
+}
+
+void Heap::release(HeapObject *object){
+    object->color = HeapColor::BLACK;
+    if(!object->isBuffered){
+        free(object);
+    }else{
+        // Still referenced by the root buffer, so only its contents are released here and the
+        // empty shell is deleted by the next collection.
+        --m_stats.liveObjects;
+        ++m_stats.totalFrees;
+        removeBytes(object->size);
+        object->size = 0;
+        object->clearRefs();
+    }
+}
+
+void Heap::possibleRoot(HeapObject *object){
+    if(object->color != HeapColor::PURPLE && object->isContainer()){
+        object->color = HeapColor::PURPLE;
+        if(!object->isBuffered){
+            object->isBuffered = true;
+            m_roots.emplace_back(object);
+        }
+    }
+}
+
+std::size_t Heap::collect(){
+    std::vector<HeapObject*> roots;
+    roots.swap(m_roots);
+
+    std::vector<HeapObject*> candidates;
+    candidates.reserve(roots.size());
+    for(HeapObject *e : roots){
+        if(e->color == HeapColor::PURPLE && e->refCount > 0){
+            markGray(e);
+            candidates.emplace_back(e);
+        }else{
+            e->isBuffered = false;
+            if(e->color == HeapColor::BLACK && e->refCount == 0){
+                delete e;
+            }
+        }
+    }
+
+    for(HeapObject *e : candidates){
+        scan(e);
+    }
+
+    std::vector<HeapObject*> garbage;
+    for(HeapObject *e : candidates){
+        e->isBuffered = false;
+        collectWhite(e, garbage);
+    }
+
+    for(HeapObject *e : garbage){
+        e->dropRefs();
+    }
+    for(HeapObject *e : garbage){
+        free(e);
+    }
+
+    ++m_stats.collections;
+    m_stats.cyclesFreed += garbage.size();
+
+    return garbage.size();
+}
+
+void Heap::markGray(HeapObject *object){
+    if(object->color == HeapColor::GRAY){
+        return;
+    }
+
+    std::vector<HeapObject*> stack = {object};
+    object->color = HeapColor::GRAY;
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        current->forEachRef([&stack](HeapObject *child){
+            --child->refCount;
+            if(child->color != HeapColor::GRAY){
+                child->color = HeapColor::GRAY;
+                stack.emplace_back(child);
+            }
+        });
+    }
+}
+
+void Heap::scan(HeapObject *object){
+    std::vector<HeapObject*> stack = {object};
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        if(current->color != HeapColor::GRAY){
+            continue;
+        }
+
+        if(current->refCount > 0){
+            scanBlack(current);
+        }else{
+            current->color = HeapColor::WHITE;
+            current->forEachRef([&stack](HeapObject *child){
+                stack.emplace_back(child);
+            });
+        }
+    }
+}
+
+void Heap::scanBlack(HeapObject *object){
+    std::vector<HeapObject*> stack = {object};
+    object->color = HeapColor::BLACK;
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        current->forEachRef([&stack](HeapObject *child){
+            ++child->refCount;
+            if(child->color != HeapColor::BLACK){
+                child->color = HeapColor::BLACK;
+                stack.emplace_back(child);
+            }
+        });
+    }
+}
+
+void Heap::collectWhite(HeapObject *object, std::vector<HeapObject*> &garbage){
+    if(object->color != HeapColor::WHITE || object->isBuffered){
+        return;
+    }
+
+    std::vector<HeapObject*> stack = {object};
+    object->color = HeapColor::BLACK;
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+        garbage.emplace_back(current);
+
+        current->forEachRef([&stack](HeapObject *child){
+            if(child->color == HeapColor::WHITE && !child->isBuffered){
+                child->color = HeapColor::BLACK;
+                stack.emplace_back(child);
+            }
+        });
+    }
+}
+
+void Heap::detach(HeapObject *object){
+    std::vector<HeapObject*> stack = {object};
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        if(current->isBuffered){
+            m_roots.erase(std::find(m_roots.begin(), m_roots.end(), current));
+            current->isBuffered = false;
+        }
+        current->color = HeapColor::BLACK;
+        current->heap = nullptr;
+        --m_stats.liveObjects;
+        removeBytes(current->size);
+
+        current->forEachRef([&stack](HeapObject *child){
+            stack.emplace_back(child);
+        });
+    }
+}
+
+Ref Heap::adopt(HeapObject *object){
+    std::vector<HeapObject*> stack = {object};
+    while(!stack.empty()){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        current->heap = this;
+        ++m_stats.liveObjects;
+        ++m_stats.totalAllocations;
+        addBytes(current->size);
+
+        current->forEachRef([&stack](HeapObject *child){
+            stack.emplace_back(child);
+        });
+    }
+    m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.liveBytes);
+
+    return Ref(object);
+}
+
+void Heap::setLimit(std::size_t bytes){
+    m_limit = bytes;
+}
+
+// The limit then counts the live bytes of every heap sharing the account, isolates share the one
+// of the script that spawned them so spawning does not multiply the limit.
+std::shared_ptr<std::atomic<std::size_t>> Heap::getAccount(){
+    if(m_account == nullptr){
+        m_account = std::make_shared<std::atomic<std::size_t>>(m_stats.liveBytes);
+    }
+
+    return m_account;
+}
+
+void Heap::shareAccount(std::shared_ptr<std::atomic<std::size_t>> account){
+    if(account == m_account){
+        return;
+    }
+
+    if(m_account != nullptr){
+        m_account->fetch_sub(m_stats.liveBytes);
+    }
+    account->fetch_add(m_stats.liveBytes);
+    m_account = account;
+}
+
+std::size_t Heap::getLimit() const{
+    return m_limit;
+}
+
+const HeapStats &Heap::getStats() const{
+    return m_stats;
+}
@@ -0,0 +1,669 @@
+#include "headers/Image.hpp"
+#include "headers/Deflate.hpp"
+#include "headers/ThreadPool.hpp"
+#include "headers/Error.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <cctype>
+
+// PNG rows are filtered and compressed in strips of about this many bytes.
+const std::size_t PNG_STRIP_BYTES = 1 << 18;
+
+/* FileWriter Class */
+// Constructor & Destructor
+FileWriter::FileWriter(const std::string &path, std::size_t capacity) : m_path(path), m_buffer(capacity){
+    m_file = std::fopen(path.c_str(), "wb");
+    if(!m_file){
+        throw ParserException("~Error~ Could not open \'" + path + "\' for writing.");
+    }
+
+    // Every write is already a large chunk, stdio buffering would only copy it again.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+}
+
+FileWriter::FileWriter(std::FILE *file, const std::string &name, std::size_t capacity) : m_file(file), m_path(name), m_buffer(capacity){
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+}
+
+FileWriter::~FileWriter(){
+    if(m_file){
+        std::fclose(m_file);
+    }
+}
+
+// Functions
+std::uint8_t *FileWriter::claim(std::size_t bytes){
+    if(m_size + bytes > m_buffer.size()){
+        flush();
+        if(bytes > m_buffer.size()){
+            m_buffer.resize(bytes);
+        }
+    }
+
+    return m_buffer.data() + m_size;
+}
+
+void FileWriter::commit(std::size_t bytes){
+    m_size += bytes;
+}
+
+void FileWriter::write(const void *data, std::size_t bytes){
+    if(bytes >= m_buffer.size() / 2){
+        flush();
+        if(std::fwrite(data, 1, bytes, m_file) != bytes){
+            throw ParserException("~Error~ Could not write to \'" + m_path + "\'.");
+        }
+        m_written += bytes;
+        return;
+    }
+
+    std::memcpy(claim(bytes), data, bytes);
+    commit(bytes);
+}
+
+void FileWriter::flush(){
+    if(m_size > 0){
+        if(std::fwrite(m_buffer.data(), 1, m_size, m_file) != m_size){
+            throw ParserException("~Error~ Could not write to \'" + m_path + "\'.");
+        }
+        m_written += m_size;
+        m_size = 0;
+    }
+}
+
+void FileWriter::close(){
+    flush();
+    int result = std::fclose(m_file);
+    m_file = nullptr;
+    if(result != 0){
+        throw ParserException("~Error~ Could not write to \'" + m_path + "\'.");
+    }
+}
+
+std::size_t FileWriter::written() const{
+    return m_written + m_size;
+}
+
+// Helper Functions
+static void putLe16(std::uint8_t *out, std::uint32_t value){
+    out[0] = value;
+    out[1] = value >> 8;
+}
+
+static void putLe32(std::uint8_t *out, std::uint32_t value){
+    putLe16(out, value);
+    putLe16(out + 2, value >> 16);
+}
+
+static void putBe32(std::uint8_t *out, std::uint32_t value){
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+}
+
+std::size_t savePpm(CanvasObject &canvas, const std::string &path){
+    canvas.flush();
+    FileWriter writer(path);
+
+    std::string header = "P6\n" + std::to_string(canvas.width) + " " + std::to_string(canvas.height) + "\n255\n";
+    writer.write(header.data(), header.size());
+    for(int y = 0; y < canvas.height; ++y){
+        const std::uint32_t *row = canvas.row(y);
+        std::uint8_t *out = writer.claim(canvas.width * 3);
+        for(int x = 0; x < canvas.width; ++x){
+            out[x * 3] = colorChannel(row[x], 0);
+            out[x * 3 + 1] = colorChannel(row[x], 1);
+            out[x * 3 + 2] = colorChannel(row[x], 2);
+        }
+        writer.commit(canvas.width * 3);
+    }
+
+    writer.close();
+    return writer.written();
+}
+
+// 24-bit BI_RGB, rows stored bottom up and padded to 4 bytes. Alpha is dropped like in PPM.
+std::size_t saveBmp(CanvasObject &canvas, const std::string &path){
+    const std::size_t rowSize = (static_cast<std::size_t>(canvas.width) * 3 + 3) & ~static_cast<std::size_t>(3);
+    const std::size_t fileSize = 54 + rowSize * canvas.height;
+    if(fileSize > UINT32_MAX){
+        throw ParserException("~Error~ Canvas is too large for a BMP file.");
+    }
+
+    canvas.flush();
+    FileWriter writer(path);
+
+    std::uint8_t header[54] = {'B', 'M'};
+    putLe32(header + 2, fileSize);
+    putLe32(header + 10, 54);
+    putLe32(header + 14, 40);
+    putLe32(header + 18, canvas.width);
+    putLe32(header + 22, canvas.height);
+    putLe16(header + 26, 1);
+    putLe16(header + 28, 24);
+    putLe32(header + 34, fileSize - 54);
+    putLe32(header + 38, 2835);
+    putLe32(header + 42, 2835);
+    writer.write(header, sizeof(header));
+
+    for(int y = canvas.height - 1; y >= 0; --y){
+        const std::uint32_t *row = canvas.row(y);
+        std::uint8_t *out = writer.claim(rowSize);
+        for(int x = 0; x < canvas.width; ++x){
+            out[x * 3] = colorChannel(row[x], 2);
+            out[x * 3 + 1] = colorChannel(row[x], 1);
+            out[x * 3 + 2] = colorChannel(row[x], 0);
+        }
+        std::fill(out + canvas.width * 3, out + rowSize, 0);
+        writer.commit(rowSize);
+    }
+
+    writer.close();
+    return writer.written();
+}
+
+static std::uint8_t paeth(int a, int b, int c){
+    int estimate = a + b - c;
+    int distanceA = std::abs(estimate - a);
+    int distanceB = std::abs(estimate - b);
+    int distanceC = std::abs(estimate - c);
+    if(distanceA <= distanceB && distanceA <= distanceC){
+        return a;
+    }
+
+    return distanceB <= distanceC ? b : c;
+}
+
+// Filters one RGBA row with the type that minimises the sum of absolute differences, the usual
+// heuristic for picking what deflate compresses best. out receives the type byte and the row.
+static void filterRow(const std::uint8_t *row, const std::uint8_t *previous, std::size_t size, std::uint8_t *out){
+    std::uint64_t sums[5] = {0};
+    for(std::size_t i = 0; i < size; ++i){
+        int a = i >= 4 ? row[i - 4] : 0;
+        int b = previous[i];
+        int c = i >= 4 ? previous[i - 4] : 0;
+        int x = row[i];
+        sums[0] += std::abs(static_cast<std::int8_t>(x));
+        sums[1] += std::abs(static_cast<std::int8_t>(x - a));
+        sums[2] += std::abs(static_cast<std::int8_t>(x - b));
+        sums[3] += std::abs(static_cast<std::int8_t>(x - ((a + b) >> 1)));
+        sums[4] += std::abs(static_cast<std::int8_t>(x - paeth(a, b, c)));
+    }
+
+    int type = static_cast<int>(std::min_element(sums, sums + 5) - sums);
+    out[0] = type;
+    for(std::size_t i = 0; i < size; ++i){
+        int a = i >= 4 ? row[i - 4] : 0;
+        int b = previous[i];
+        int c = i >= 4 ? previous[i - 4] : 0;
+        int predicted = type == 0 ? 0 : type == 1 ? a : type == 2 ? b : type == 3 ? (a + b) >> 1 : paeth(a, b, c);
+        out[i + 1] = row[i] - predicted;
+    }
+}
+
+static void writeChunk(FileWriter &writer, const char *type, const std::vector<std::pair<const std::uint8_t*, std::size_t>> &parts){
+    std::size_t length = 0;
+    for(const auto &e : parts){
+        length += e.second;
+    }
+
+    std::uint8_t header[8];
+    putBe32(header, length);
+    std::memcpy(header + 4, type, 4);
+    writer.write(header, 8);
+
+    std::uint32_t crc = crc32(header + 4, 4);
+    for(const auto &e : parts){
+        crc = crc32(e.first, e.second, crc);
+        writer.write(e.first, e.second);
+    }
+
+    std::uint8_t footer[4];
+    putBe32(footer, crc);
+    writer.write(footer, 4);
+}
+
+// RGBA8 PNG. Rows are filtered and deflated a wave of strips at a time on the shared pool, each
+// strip using the filtered bytes before it as history, so only one wave is ever held in memory.
+std::size_t savePng(CanvasObject &canvas, const std::string &path){
+    canvas.flush();
+    FileWriter writer(path);
+
+    static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    writer.write(signature, 8);
+
+    std::uint8_t header[13] = {0};
+    putBe32(header, canvas.width);
+    putBe32(header + 4, canvas.height);
+    header[8] = 8;
+    header[9] = 6;
+    writeChunk(writer, "IHDR", {{header, sizeof(header)}});
+
+    // Pixels are stored R, G, B, A in memory, which is already the PNG byte order.
+    const std::size_t pixelBytes = static_cast<std::size_t>(canvas.width) * 4;
+    const std::size_t rowBytes = pixelBytes + 1;
+    const int stripRows = static_cast<int>(std::max<std::size_t>(1, PNG_STRIP_BYTES / rowBytes));
+    const int stripCount = (canvas.height + stripRows - 1) / stripRows;
+
+    ThreadPool &pool = sharedThreadPool();
+    const int waveStrips = static_cast<int>(pool.size() + 1) * 2;
+    const std::vector<std::uint8_t> zeroRow(pixelBytes, 0);
+    std::vector<std::uint8_t> filtered;
+    std::vector<std::vector<std::uint8_t>> compressed(waveStrips);
+    std::vector<std::uint32_t> checksums(waveStrips);
+    std::uint32_t adler = 1;
+
+    for(int firstStrip = 0; firstStrip < stripCount; firstStrip += waveStrips){
+        int strips = std::min(waveStrips, stripCount - firstStrip);
+        int firstRow = firstStrip * stripRows;
+        int lastRow = std::min(canvas.height, (firstStrip + strips) * stripRows);
+
+        std::size_t history = std::min(filtered.size(), DEFLATE_WINDOW);
+        std::copy(filtered.end() - history, filtered.end(), filtered.begin());
+        filtered.resize(history + (lastRow - firstRow) * rowBytes);
+
+        pool.parallelFor(lastRow - firstRow, [&](std::size_t i){
+            int y = firstRow + static_cast<int>(i);
+            const std::uint8_t *row = reinterpret_cast<const std::uint8_t*>(canvas.row(y));
+            const std::uint8_t *previous = y > 0 ? reinterpret_cast<const std::uint8_t*>(canvas.row(y - 1)) : zeroRow.data();
+            filterRow(row, previous, pixelBytes, filtered.data() + history + i * rowBytes);
+        });
+
+        pool.parallelFor(strips, [&](std::size_t strip){
+            std::size_t start = history + strip * stripRows * rowBytes;
+            std::size_t end = std::min(start + stripRows * rowBytes, filtered.size());
+            compressed[strip].clear();
+            deflateStrip(filtered.data(), start, end, firstStrip + static_cast<int>(strip) + 1 == stripCount, compressed[strip]);
+            checksums[strip] = adler32(filtered.data() + start, end - start);
+        });
+
+        for(int strip = 0; strip < strips; ++strip){
+            std::size_t start = history + strip * stripRows * rowBytes;
+            std::size_t end = std::min(start + stripRows * rowBytes, filtered.size());
+            adler = adler32Combine(adler, checksums[strip], end - start);
+
+            static const std::uint8_t zlibHeader[2] = {0x78, 0x9C};
+            std::uint8_t trailer[4];
+            putBe32(trailer, adler);
+
+            bool isFirst = firstStrip + strip == 0;
+            bool isLast = firstStrip + strip + 1 == stripCount;
+            writeChunk(writer, "IDAT", {{zlibHeader, isFirst ? 2u : 0u}, {compressed[strip].data(), compressed[strip].size()}, {trailer, isLast ? 4u : 0u}});
+        }
+    }
+
+    writeChunk(writer, "IEND", {});
+    writer.close();
+    return writer.written();
+}
+
+ImageFormat parseImageFormat(const std::string &path, const std::string &format){
+    std::string name = format;
+    if(name.empty()){
+        std::size_t dot = path.find_last_of('.');
+        name = dot == std::string::npos ? "" : path.substr(dot + 1);
+    }
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char e){ return std::tolower(e); });
+
+    if(name == "ppm"){
+        return ImageFormat::PPM;
+    }else if(name == "bmp"){
+        return ImageFormat::BMP;
+    }else if(name == "png"){
+        return ImageFormat::PNG;
+    }
+
+    throw ParserException("~Error~ Unknown image format \'" + name + "\', expected ppm, bmp or png.");
+}
+
+std::size_t saveImage(CanvasObject &canvas, const std::string &path, ImageFormat format){
+    switch(format){
+        case ImageFormat::PPM:
+            return savePpm(canvas, path);
+        case ImageFormat::BMP:
+            return saveBmp(canvas, path);
+        default:
+            return savePng(canvas, path);
+    }
+}
+
+// Helper Functions
+static std::uint32_t getLe16(const std::uint8_t *data){
+    return data[0] | (data[1] << 8);
+}
+
+static std::uint32_t getLe32(const std::uint8_t *data){
+    return getLe16(data) | (getLe16(data + 2) << 16);
+}
+
+static std::uint32_t getBe32(const std::uint8_t *data){
+    return (static_cast<std::uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+// A few header bytes can claim any size, so it is checked before the rest of the file is trusted.
+static void checkImageSize(std::int64_t width, std::int64_t height){
+    if(width <= 0 || height <= 0 || width > 65535 || height > 65535 || width * height > MAX_IMAGE_PIXELS){
+        throw ParserException("~Error~ Invalid image size " + std::to_string(width) + "x" + std::to_string(height) + ".");
+    }
+}
+
+static std::unique_ptr<CanvasObject> makeImage(std::int64_t width, std::int64_t height, Heap *heap){
+    checkImageSize(width, height);
+    if(heap != nullptr){
+        heap->reserve(CanvasObject::byteSizeFor(width, height));
+    }
+
+    return std::make_unique<CanvasObject>(width, height);
+}
+
+static void invalidImage(const std::string &format){
+    throw ParserException("~Error~ Invalid or unsupported " + format + " image.");
+}
+
+std::unique_ptr<CanvasObject> decodePpm(const std::uint8_t *data, std::size_t size, Heap *heap){
+    std::size_t position = 2;
+    auto readNumber = [&](){
+        // Whitespace and comments may separate the header fields.
+        while(position < size && (std::isspace(data[position]) || data[position] == '#')){
+            if(data[position] == '#'){
+                while(position < size && data[position] != '\n'){
+                    ++position;
+                }
+            }else{
+                ++position;
+            }
+        }
+
+        std::int64_t value = 0;
+        std::size_t digits = 0;
+        for(; position < size && std::isdigit(data[position]) && digits < 9; ++position, ++digits){
+            value = value * 10 + (data[position] - '0');
+        }
+        if(digits == 0){
+            invalidImage("PPM");
+        }
+        return value;
+    };
+
+    if(size < 2 || data[0] != 'P' || data[1] != '6'){
+        invalidImage("PPM");
+    }
+
+    std::int64_t width = readNumber();
+    std::int64_t height = readNumber();
+    std::int64_t maximum = readNumber();
+    ++position;
+    if(maximum <= 0 || maximum > 65535){
+        invalidImage("PPM");
+    }
+
+    std::size_t sampleBytes = maximum > 255 ? 2 : 1;
+    checkImageSize(width, height);
+    if(position > size || (size - position) / (3 * sampleBytes) / width < static_cast<std::size_t>(height)){
+        invalidImage("PPM");
+    }
+    std::unique_ptr<CanvasObject> image = makeImage(width, height, heap);
+
+    const std::uint8_t *source = data + position;
+    for(int y = 0; y < image->height; ++y){
+        std::uint32_t *row = image->row(y);
+        for(int x = 0; x < image->width; ++x){
+            std::uint8_t channels[3];
+            for(int channel = 0; channel < 3; ++channel){
+                std::uint32_t sample = sampleBytes == 2 ? (source[0] << 8) | source[1] : source[0];
+                channels[channel] = maximum == 255 ? sample : (sample * 255 + maximum / 2) / maximum;
+                source += sampleBytes;
+            }
+            row[x] = packColor(channels[0], channels[1], channels[2]);
+        }
+    }
+
+    return image;
+}
+
+// BI_RGB with 24 or 32 bits and BI_BITFIELDS with 32 bits, in either row order.
+std::unique_ptr<CanvasObject> decodeBmp(const std::uint8_t *data, std::size_t size, Heap *heap){
+    if(size < 54 || data[0] != 'B' || data[1] != 'M'){
+        invalidImage("BMP");
+    }
+
+    std::uint32_t pixelOffset = getLe32(data + 10);
+    std::uint32_t headerSize = getLe32(data + 14);
+    std::int32_t width = static_cast<std::int32_t>(getLe32(data + 18));
+    std::int32_t height = static_cast<std::int32_t>(getLe32(data + 22));
+    std::uint32_t bitCount = getLe16(data + 28);
+    std::uint32_t compression = getLe32(data + 30);
+    bool isTopDown = height < 0;
+    if(headerSize < 40 || (bitCount != 24 && bitCount != 32) || (compression != 0 && !(compression == 3 && bitCount == 32))){
+        invalidImage("BMP");
+    }
+
+    // Masks follow a 40 byte header or sit inside a V4/V5 one, the alpha mask only exists in the latter.
+    std::uint32_t masks[4] = {0x00FF0000, 0x0000FF00, 0x000000FF, 0};
+    if(compression == 3){
+        if(size < 14 + 40 + 12){
+            invalidImage("BMP");
+        }
+        for(int i = 0; i < 3; ++i){
+            masks[i] = getLe32(data + 54 + i * 4);
+        }
+        if(headerSize >= 56 && size >= 14 + 56){
+            masks[3] = getLe32(data + 66);
+        }
+    }
+
+    std::int64_t rows = isTopDown ? -static_cast<std::int64_t>(height) : height;
+    checkImageSize(width, rows);
+    std::size_t bytesPerPixel = bitCount / 8;
+    std::size_t rowSize = (width * bytesPerPixel + 3) & ~static_cast<std::size_t>(3);
+    if(pixelOffset > size || (size - pixelOffset) / rowSize < static_cast<std::size_t>(rows)){
+        invalidImage("BMP");
+    }
+    std::unique_ptr<CanvasObject> image = makeImage(width, rows, heap);
+
+    auto extract = [](std::uint32_t value, std::uint32_t mask) -> std::uint8_t{
+        if(mask == 0){
+            return 255;
+        }
+        int shift = __builtin_ctz(mask);
+        std::uint32_t maximum = mask >> shift;
+        return maximum == 255 ? (value & mask) >> shift : ((value & mask) >> shift) * 255 / maximum;
+    };
+
+    for(int y = 0; y < image->height; ++y){
+        const std::uint8_t *source = data + pixelOffset + (isTopDown ? y : image->height - 1 - y) * rowSize;
+        std::uint32_t *row = image->row(y);
+        for(int x = 0; x < image->width; ++x, source += bytesPerPixel){
+            if(bitCount == 24){
+                row[x] = packColor(source[2], source[1], source[0]);
+            }else{
+                std::uint32_t value = getLe32(source);
+                row[x] = packColor(extract(value, masks[0]), extract(value, masks[1]), extract(value, masks[2]), extract(value, masks[3]));
+            }
+        }
+    }
+
+    return image;
+}
+
+static void unfilterRow(std::uint8_t *row, const std::uint8_t *previous, std::size_t size, std::size_t bpp, std::uint8_t type){
+    for(std::size_t i = 0; i < size; ++i){
+        int a = i >= bpp ? row[i - bpp] : 0;
+        int b = previous[i];
+        int c = i >= bpp ? previous[i - bpp] : 0;
+        switch(type){
+            case 0:
+                break;
+            case 1:
+                row[i] += a;
+                break;
+            case 2:
+                row[i] += b;
+                break;
+            case 3:
+                row[i] += (a + b) >> 1;
+                break;
+            case 4:
+                row[i] += paeth(a, b, c);
+                break;
+            default:
+                invalidImage("PNG");
+        }
+    }
+}
+
+std::unique_ptr<CanvasObject> decodePng(const std::uint8_t *data, std::size_t size, Heap *heap){
+    static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if(size < 8 || std::memcmp(data, signature, 8) != 0){
+        invalidImage("PNG");
+    }
+
+    std::uint32_t width = 0, height = 0;
+    int bitDepth = 0, colorType = -1;
+    std::vector<std::uint8_t> compressed;
+    std::uint32_t palette[256];
+    std::fill(palette, palette + 256, packColor(0, 0, 0));
+    int transparentKey[3] = {-1, -1, -1};
+
+    for(std::size_t position = 8; position + 12 <= size;){
+        std::uint32_t length = getBe32(data + position);
+        const std::uint8_t *type = data + position + 4;
+        const std::uint8_t *chunk = type + 4;
+        if(length > size - position - 12 || crc32(type, length + 4) != getBe32(chunk + length)){
+            invalidImage("PNG");
+        }
+
+        if(std::memcmp(type, "IHDR", 4) == 0 && length >= 13){
+            width = getBe32(chunk);
+            height = getBe32(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+            if(chunk[12] != 0){
+                throw ParserException("~Error~ Interlaced PNG images are not supported.");
+            }
+        }else if(std::memcmp(type, "PLTE", 4) == 0){
+            for(std::uint32_t i = 0; i < length / 3 && i < 256; ++i){
+                palette[i] = packColor(chunk[i * 3], chunk[i * 3 + 1], chunk[i * 3 + 2]);
+            }
+        }else if(std::memcmp(type, "tRNS", 4) == 0){
+            if(colorType == 3){
+                for(std::uint32_t i = 0; i < length && i < 256; ++i){
+                    palette[i] = (palette[i] & 0x00FFFFFF) | (static_cast<std::uint32_t>(chunk[i]) << 24);
+                }
+            }else if(colorType == 0 && length >= 2){
+                transparentKey[0] = (chunk[0] << 8) | chunk[1];
+            }else if(colorType == 2 && length >= 6){
+                for(int i = 0; i < 3; ++i){
+                    transparentKey[i] = (chunk[i * 2] << 8) | chunk[i * 2 + 1];
+                }
+            }
+        }else if(std::memcmp(type, "IDAT", 4) == 0){
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        }else if(std::memcmp(type, "IEND", 4) == 0){
+            break;
+        }
+        position += length + 12;
+    }
+
+    static const int channelCounts[7] = {1, 0, 3, 1, 2, 0, 4};
+    if(colorType < 0 || colorType > 6 || channelCounts[colorType] == 0 || (bitDepth != 1 && bitDepth != 2 && bitDepth != 4 && bitDepth != 8 && bitDepth != 16)){
+        invalidImage("PNG");
+    }
+
+    checkImageSize(width, height);
+    const int channels = channelCounts[colorType];
+    const std::size_t rowBytes = (static_cast<std::size_t>(width) * channels * bitDepth + 7) / 8;
+    const std::size_t bpp = std::max(1, channels * bitDepth / 8);
+
+    // Deflate expands at most about 1032 to 1, so a small IDAT cannot make the buffer grow large.
+    const std::size_t rawSize = (rowBytes + 1) * height;
+    std::vector<std::uint8_t> raw;
+    raw.reserve(std::min(rawSize, compressed.size() * 1032));
+    inflateZlib(compressed.data(), compressed.size(), raw, rawSize);
+    if(raw.size() < rawSize){
+        invalidImage("PNG");
+    }
+
+    std::unique_ptr<CanvasObject> image = makeImage(width, height, heap);
+
+    // Samples are scaled to 8 bits, 16-bit ones keep their high byte.
+    const std::uint32_t sampleMaximum = (1u << bitDepth) - 1;
+    auto sample = [&](const std::uint8_t *row, std::size_t index) -> std::uint32_t{
+        if(bitDepth == 8){
+            return row[index];
+        }else if(bitDepth == 16){
+            return (row[index * 2] << 8) | row[index * 2 + 1];
+        }
+
+        std::size_t bit = index * bitDepth;
+        return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & sampleMaximum;
+    };
+    auto scale = [&](std::uint32_t value) -> std::uint8_t{
+        return bitDepth == 16 ? value >> 8 : bitDepth == 8 ? value : value * 255 / sampleMaximum;
+    };
+
+    std::vector<std::uint8_t> zeroRow(rowBytes, 0);
+    for(std::uint32_t y = 0; y < height; ++y){
+        std::uint8_t *row = raw.data() + y * (rowBytes + 1);
+        const std::uint8_t *previous = y > 0 ? row - rowBytes : zeroRow.data();
+        unfilterRow(row + 1, previous, rowBytes, bpp, row[0]);
+        ++row;
+
+        std::uint32_t *out = image->row(y);
+        for(std::uint32_t x = 0; x < width; ++x){
+            std::size_t index = static_cast<std::size_t>(x) * channels;
+            switch(colorType){
+                case 0:{
+                    std::uint32_t gray = sample(row, index);
+                    out[x] = packColor(scale(gray), scale(gray), scale(gray), static_cast<int>(gray) == transparentKey[0] ? 0 : 255);
+                    break;
+                }
+                case 2:{
+                    std::uint32_t r = sample(row, index), g = sample(row, index + 1), b = sample(row, index + 2);
+                    bool isTransparent = static_cast<int>(r) == transparentKey[0] && static_cast<int>(g) == transparentKey[1] && static_cast<int>(b) == transparentKey[2];
+                    out[x] = packColor(scale(r), scale(g), scale(b), isTransparent ? 0 : 255);
+                    break;
+                }
+                case 3:
+                    out[x] = palette[sample(row, index) & 0xFF];
+                    break;
+                case 4:
+                    out[x] = packColor(scale(sample(row, index)), scale(sample(row, index)), scale(sample(row, index)), scale(sample(row, index + 1)));
+                    break;
+                default:
+                    out[x] = packColor(scale(sample(row, index)), scale(sample(row, index + 1)), scale(sample(row, index + 2)), scale(sample(row, index + 3)));
+                    break;
+            }
+        }
+    }
+
+    return image;
+}
+
+std::unique_ptr<CanvasObject> decodeImage(const std::uint8_t *data, std::size_t size, const std::string &path, Heap *heap){
+    if(size >= 8 && data[0] == 0x89 && data[1] == 'P'){
+        return decodePng(data, size, heap);
+    }else if(size >= 2 && data[0] == 'B' && data[1] == 'M'){
+        return decodeBmp(data, size, heap);
+    }else if(size >= 2 && data[0] == 'P' && data[1] == '6'){
+        return decodePpm(data, size, heap);
+    }
+
+    throw ParserException("~Error~ Unknown image format in \'" + path + "\'.");
+}
+
+std::unique_ptr<CanvasObject> loadImageFile(const std::string &path, Heap *heap){
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file){
+        throw ParserException("~Error~ Could not open \'" + path + "\'.");
+    }
+
+    std::vector<std::uint8_t> data(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    return decodeImage(data.data(), data.size(), path, heap);
+}
@@ -1,5 +1,7 @@
 #include "headers/Interpreter.hpp"
 
+const std::string DEFAULT_REGEX_PATTERN = "(\"[^\"]*\"|[@A-Za-z_]+)|([0-9]+)(\\.[0-9]*)?|(==|>=|>|<=|<|!=|!|&&|\\|\\|)|([\\+\\-\\*\\/\\%\\^]?\\=)|(\\+\\+|\\+|\\-\\-|\\-|\\*|\\/|\\%|\\^|\\.)|(\\(|\\)|\\{|\\}|\\[|\\]|;|:|\\,)|(\\n)";
+
 /* Interpreter Class */
 // Constructor & Destructor
 Interpreter::Interpreter(){
@@ -16,8 +18,11 @@ RET_CODE Interpreter::execute(std::string &str, ScopeManager &scope, DebugType d
         return RET_CODE::OK;
     }
 
-    static const std::string DEFAULT_REGEX_PATTERN = "(\"[^\"]*\"|[@A-Za-z_]+)|([0-9]+)(\\.[0-9]*)?|(==|>=|>|<=|<|!=|!|&&|\\|\\|)|([\\+\\-\\*\\/\\%\\^]?\\=)|(\\+\\+|\\+|\\-\\-|\\-|\\*|\\/|\\%|\\^|\\.)|(\\(|\\)|\\{|\\}|\\[|\\]|;|:|\\,)|(\\n)";
-    std::vector<Token> tokens = lex(str, DEFAULT_REGEX_PATTERN);
+    std::vector<Token> tokens;
+    {
+        TraceSpan span("lex", "interpreter");
+        tokens = lex(str, DEFAULT_REGEX_PATTERN);
+    }
     
     if(debugType == DebugType::SHOW_PARSING || debugType == DebugType::DETAILED){
         debug_outTokens(tokens);
@@ -25,7 +30,11 @@ RET_CODE Interpreter::execute(std::string &str, ScopeManager &scope, DebugType d
 
     try{
         auto compileStartTime = std::chrono::high_resolution_clock::now();
-        std::shared_ptr<AbstractNode> treeRoot = m_parser.parse(tokens);
+        std::shared_ptr<AbstractNode> treeRoot;
+        {
+            TraceSpan span("parse", "interpreter");
+            treeRoot = m_parser.parse(tokens);
+        }
         auto compileEndTime = std::chrono::high_resolution_clock::now();
         auto compileTime = std::chrono::duration_cast<std::chrono::milliseconds>(compileEndTime - compileStartTime);
 
@@ -36,23 +45,50 @@ RET_CODE Interpreter::execute(std::string &str, ScopeManager &scope, DebugType d
         }
         
         this->m_executedRoot = treeRoot;
-        NodeInfo rootResult = treeRoot->eval(scope);
+        scope.sources.emplace_back(LoadedSource{std::make_shared<const std::string>(str), treeRoot});
+        {
+            TraceSpan span("execute", "interpreter");
+            MemoryScope memory(MemoryCategory::VALUES);
+            treeRoot->eval(scope);
+        }
         auto executionEndTime = std::chrono::high_resolution_clock::now();
         auto executionTime = std::chrono::duration_cast<std::chrono::milliseconds>(executionEndTime - compileStartTime);
 
         if(debugType == DebugType::TIME_ONLY || debugType == DebugType::DETAILED){
             std::cout << "\nExited in " << executionTime.count() << "ms P/E(" << compileTime.count() << "ms, " << executionTime.count() - compileTime.count() << "ms)." << std::endl;
         }
-    }catch(Error err){
+    }catch(const Error &err){
         std::cout << err.what() << std::endl;
 
         return RET_CODE::ERR; 
+    }catch(const std::bad_alloc&){
+        std::cout << "~Error~ Out of memory." << std::endl;
+
+        return RET_CODE::ERR;
+    }catch(const std::exception &err){
+        std::cout << "~Error~ " << err.what() << std::endl;
+
+        return RET_CODE::ERR;
     }
 
     return RET_CODE::OK;
 }
 
+// Lexes and parses without running, syntax errors are thrown.
+std::shared_ptr<const Program> Interpreter::compile(const std::string &str){
+    std::vector<Token> tokens;
+    {
+        TraceSpan span("lex", "interpreter");
+        tokens = lex(str, DEFAULT_REGEX_PATTERN);
+    }
+
+    TraceSpan span("parse", "interpreter");
+    std::shared_ptr<AbstractNode> root = m_parser.parse(tokens);
+    return root == nullptr ? nullptr : std::make_shared<const Program>(root, std::make_shared<const std::string>(str));
+}
+
 std::vector<Token> Interpreter::lex(const std::string &str, const std::string &pattern){
+    MemoryScope memory(MemoryCategory::TOKENS);
     Regex DEFAULT_REGEX(pattern);
     std::vector<std::string> matches = DEFAULT_REGEX.boostMatchAll(str);
     
@@ -179,8 +215,11 @@ std::shared_ptr<AbstractNode> TreeParser::parse(std::vector<Token> &tokenList){
     }
 
     m_tokens = &tokenList;
+    m_currTokenIndex = 0;
     m_currToken = &m_tokens->at(0);
+    m_isParsingUnary = false;
     
+    MemoryScope memory(MemoryCategory::AST);
     return parseBlockStatement();
 }
 
@@ -213,6 +252,7 @@ std::shared_ptr<AbstractNode> TreeParser::parseBlockStatement(bool isPost){
 
 std::shared_ptr<AbstractNode> TreeParser::parseStatement(){
     std::shared_ptr<AbstractNode> result;
+    unsigned int row = m_currToken->row;
 
     if((m_currToken->type == TokenType::NUM_LIT || m_currToken->type == TokenType::STR_LIT) || m_currToken->type == TokenType::IDN || m_currToken->type == TokenType::OPR || m_currToken->value == "("){
         std::string &nextTokenValue = nextToken()->value;
@@ -313,6 +353,10 @@ std::shared_ptr<AbstractNode> TreeParser::parseStatement(){
         throw SyntaxError("Invalid Token \'" + m_currToken->value + "\'.", m_currToken->row, m_currToken->col);
     }
 
+    if(result != nullptr){
+        result->row = row;
+    }
+
     return result;
 }
 
@@ -485,9 +529,11 @@ std::shared_ptr<AbstractNode> TreeParser::parseFactor(){
         {
             if(m_currToken->value == "def"){
                 consume(TokenType::KEY);
-                result = std::make_shared<DefLambdaStatement>();
-                result->attach(parseTupleStatement());
-                result->attach(parseBlockStatement(true));
+                std::shared_ptr<DefLambdaStatement> lambda = std::make_shared<DefLambdaStatement>();
+                lambda->attach(parseTupleStatement());
+                lambda->attach(parseBlockStatement(true));
+                lambda->collectCaptures();
+                result = lambda;
             }
         }
         break;
@@ -0,0 +1,258 @@
+#include "headers/Isolate.hpp"
+#include "headers/AST.hpp"
+
+/* MessageQueue Class */
+// Functions
+void MessageQueue::push(Message &&message){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_messages.emplace_back(std::move(message));
+    }
+    m_condition.notify_one();
+}
+
+bool MessageQueue::pop(Message &message){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]{ return !m_messages.empty() || m_isClosed; });
+
+    if(m_messages.empty()){
+        return false;
+    }
+
+    message = std::move(m_messages.front());
+    m_messages.pop_front();
+
+    return true;
+}
+
+void MessageQueue::close(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isClosed = true;
+    }
+    m_condition.notify_all();
+}
+
+/* Isolate Class */
+// Constructor & Destructor
+Isolate::Isolate(std::string fileName, ExecutionLimits limits) : m_fileName(fileName), m_limits(limits), m_exitCode(RET_CODE::NONE){}
+
+Isolate::~Isolate(){
+    inbox.close();
+    join();
+}
+
+// Functions
+void Isolate::run(){
+    try{
+        runWithStackSize(nativeStackSizeFor(m_limits.maxCallDepth), [this](){
+            Interpreter isolateInterpreter;
+            ScopeManager isolateScope;
+            isolateScope.isolate = this;
+            isolateScope.applyLimits(m_limits);
+
+            tracer().nameThread("isolate " + m_fileName);
+            std::string code;
+            {
+                TraceSpan span("load " + m_fileName, "interpreter");
+                code = loadFileContentAsCode(m_fileName);
+            }
+            m_exitCode = isolateInterpreter.execute(code, isolateScope, DebugType::NONE);
+        });
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        m_exitCode = RET_CODE::ERR;
+    }
+
+    outbox.close();
+}
+
+void Isolate::start(){
+    m_thread = std::thread(&Isolate::run, this);
+}
+
+RET_CODE Isolate::join(){
+    if(m_thread.joinable()){
+        m_thread.join();
+    }
+
+    return m_exitCode;
+}
+
+// Serialisation
+// Values are written as a tag byte followed by the raw value, lists recursively element by element.
+void serializeValue(const Data &data, Message &message){
+    std::string &payload = message.payload;
+
+    if(const auto *intPtr = std::get_if<std::int32_t>(&data)){
+        payload.push_back(static_cast<char>(ValueTag::NUM_INT));
+        payload.append(reinterpret_cast<const char*>(intPtr), sizeof(std::int32_t));
+    }else if(const auto *floatPtr = std::get_if<float>(&data)){
+        payload.push_back(static_cast<char>(ValueTag::NUM_FLOAT));
+        payload.append(reinterpret_cast<const char*>(floatPtr), sizeof(float));
+    }else if(const auto *strPtr = std::get_if<std::string>(&data)){
+        std::uint32_t length = strPtr->size();
+        payload.push_back(static_cast<char>(ValueTag::STR));
+        payload.append(reinterpret_cast<const char*>(&length), sizeof(std::uint32_t));
+        payload.append(*strPtr);
+    }else if(std::holds_alternative<Ref>(data) && std::get<Ref>(data).get()->kind == HeapObjectType::LIST){
+        std::vector<Data> &elements = std::get<Ref>(data).as<ListObject>()->elements;
+        std::uint32_t count = elements.size();
+        payload.push_back(static_cast<char>(ValueTag::LIST));
+        payload.append(reinterpret_cast<const char*>(&count), sizeof(std::uint32_t));
+        for(auto &e : elements){
+            serializeValue(e, message);
+        }
+    }else{
+        throw ParserException("~Error~ Only numbers, strings and lists can be sent between isolates.");
+    }
+}
+
+// Transfers hand a list over without copying it. The sender's binding is cleared first; if
+// nothing else references the object graph and it holds only lists, numbers and strings it is
+// detached from the sending heap and moved into the message, otherwise the binding is restored and
+// the value is copied like a normal send. Functions and closures point into the sender's tree and
+// scopes, so they are refused like any send refuses them.
+void transferValue(NodeInfo &info, Data *binding, Message &message){
+    if(!std::holds_alternative<Ref>(info.data)){
+        serializeValue(info.data, message);
+        return;
+    }
+
+    Ref ref = std::get<Ref>(info.data);
+    info.data = 0;
+    if(binding != nullptr){
+        *binding = 0;
+    }
+
+    bool isMovable = true;
+    std::vector<HeapObject*> stack = {ref.get()};
+    while(!stack.empty() && isMovable){
+        HeapObject *current = stack.back();
+        stack.pop_back();
+
+        isMovable = current->refCount == 1 && current->kind == HeapObjectType::LIST;
+        if(isMovable){
+            for(auto &e : static_cast<ListObject*>(current)->elements){
+                isMovable = isMovable && !std::holds_alternative<void*>(e);
+            }
+        }
+        current->forEachRef([&stack](HeapObject *child){
+            stack.emplace_back(child);
+        });
+    }
+
+    if(!isMovable){
+        if(binding != nullptr){
+            *binding = ref;
+        }
+        serializeValue(ref, message);
+        return;
+    }
+
+    ref.get()->heap->detach(ref.get());
+    HeapObject *object = ref.release();
+    object->refCount = 0;
+
+    std::uint32_t index = message.transfers.size();
+    message.transfers.emplace_back(object);
+    message.payload.push_back(static_cast<char>(ValueTag::TRANSFER));
+    message.payload.append(reinterpret_cast<const char*>(&index), sizeof(std::uint32_t));
+}
+
+NodeInfo deserializeValue(Message &message, std::size_t &offset, ScopeManager &scope){
+    const std::string &payload = message.payload;
+    ValueTag tag = static_cast<ValueTag>(payload.at(offset++));
+
+    switch(tag){
+    case ValueTag::NUM_INT:
+        {
+            std::int32_t value;
+            payload.copy(reinterpret_cast<char*>(&value), sizeof(std::int32_t), offset);
+            offset += sizeof(std::int32_t);
+            return NodeInfo(NodeType::NUM_LIT, value);
+        }
+    case ValueTag::NUM_FLOAT:
+        {
+            float value;
+            payload.copy(reinterpret_cast<char*>(&value), sizeof(float), offset);
+            offset += sizeof(float);
+            return NodeInfo(NodeType::NUM_LIT, value);
+        }
+    case ValueTag::STR:
+        {
+            std::uint32_t length;
+            payload.copy(reinterpret_cast<char*>(&length), sizeof(std::uint32_t), offset);
+            offset += sizeof(std::uint32_t);
+            Data value = payload.substr(offset, length);
+            offset += length;
+            return NodeInfo(NodeType::STR_LIT, value);
+        }
+    case ValueTag::LIST:
+        {
+            std::uint32_t count;
+            payload.copy(reinterpret_cast<char*>(&count), sizeof(std::uint32_t), offset);
+            offset += sizeof(std::uint32_t);
+
+            std::vector<Data> elements;
+            elements.reserve(count);
+            for(std::uint32_t i = 0; i < count; ++i){
+                elements.emplace_back(deserializeValue(message, offset, scope).data);
+            }
+
+            return NodeInfo(NodeType::OBJ, scope.getHeap().make<ListObject>(std::move(elements)));
+        }
+    case ValueTag::TRANSFER:
+        {
+            std::uint32_t index;
+            payload.copy(reinterpret_cast<char*>(&index), sizeof(std::uint32_t), offset);
+            offset += sizeof(std::uint32_t);
+
+            HeapObject *object = message.transfers.at(index).release();
+            return NodeInfo(NodeType::OBJ, scope.getHeap().adopt(object));
+        }
+    default:
+        throw ParserException("~Error~ Malformed isolate message.");
+    }
+}
+
+// Helper Functions
+unsigned int spawnIsolate(ScopeManager &scope, const std::string &fileName){
+    std::shared_ptr<Isolate> isolate = std::make_shared<Isolate>(fileName, scope.remainingLimits());
+    scope.isolates.emplace_back(isolate);
+    isolate->start();
+
+    return scope.isolates.size() - 1;
+}
+
+Isolate *findIsolate(ScopeManager &scope, NodeInfo &handle){
+    if(handle.type == NodeType::NUM_LIT){
+        int index = static_cast<int>(variantAsNum(handle.data));
+        if(index >= 0 && static_cast<std::size_t>(index) < scope.isolates.size()){
+            return scope.isolates[index].get();
+        }
+    }
+
+    throw ParserException("~Error~ Invalid isolate handle \'" + variantAsStr(handle.data) + "\'.");
+}
+
+// The parent addresses a child by handle, a child talks to its parent without one.
+MessageQueue &findSendQueue(ScopeManager &scope, std::vector<NodeInfo> &argsList, const std::string &identifier){
+    if(argsList.size() == 2){
+        return findIsolate(scope, argsList[0])->inbox;
+    }else if(argsList.size() == 1 && scope.isolate != nullptr){
+        return scope.isolate->outbox;
+    }
+
+    throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+}
+
+MessageQueue &findReceiveQueue(ScopeManager &scope, std::vector<NodeInfo> &argsList, const std::string &identifier){
+    if(argsList.size() == 1){
+        return findIsolate(scope, argsList[0])->outbox;
+    }else if(argsList.empty() && scope.isolate != nullptr){
+        return scope.isolate->inbox;
+    }
+
+    throw ParserException("~Error~ Invalid arguments for \'" + identifier + "\'.");
+}
@@ -0,0 +1,213 @@
+#include "headers/Kernels.hpp"
+#include "headers/Canvas.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define CANVAS_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+/* Scalar Kernels */
+static void scalarFill(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    std::fill_n(dst, count, color);
+}
+
+static void scalarFillBlend(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    for(std::size_t i = 0; i < count; ++i){
+        dst[i] = blendPixel(dst[i], color);
+    }
+}
+
+static void scalarCopy(std::uint32_t *dst, const std::uint32_t *src, std::size_t count){
+    std::memmove(dst, src, count * sizeof(std::uint32_t));
+}
+
+static void scalarCopyBlend(std::uint32_t *dst, const std::uint32_t *src, std::size_t count){
+    for(std::size_t i = 0; i < count; ++i){
+        dst[i] = blendPixel(dst[i], src[i]);
+    }
+}
+
+// |sum| clamped to one pixel and scaled to 0-255 with rounding, x * 255 is computed as (x << 8) - x.
+static std::int32_t scalarCoverage(const std::int32_t *cells, std::uint8_t *alpha, std::size_t count, std::int32_t sum){
+    for(std::size_t i = 0; i < count; ++i){
+        sum += cells[i];
+        alpha[i] = coverageToAlpha(sum);
+    }
+
+    return sum;
+}
+
+#ifdef CANVAS_X86_KERNELS
+/* SSE2 Kernels */
+// Pixels are widened to 16-bit lanes where s * a + d * (255 - a) still fits, the source alpha lane
+// is forced to 255 first so the same expression yields a + da * (255 - a) / 255 for alpha.
+__attribute__((target("sse2"))) static inline __m128i sse2Div255(__m128i x){
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2"))) static inline __m128i sse2Blend(__m128i dst, __m128i src){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    const __m128i full = _mm_set1_epi16(255);
+    __m128i source = _mm_or_si128(src, alphaMask);
+
+    __m128i srcLow = _mm_unpacklo_epi8(source, zero);
+    __m128i srcHigh = _mm_unpackhi_epi8(source, zero);
+    __m128i alphaLow = _mm_unpacklo_epi8(src, zero);
+    __m128i alphaHigh = _mm_unpackhi_epi8(src, zero);
+    alphaLow = _mm_shufflehi_epi16(_mm_shufflelo_epi16(alphaLow, 0xFF), 0xFF);
+    alphaHigh = _mm_shufflehi_epi16(_mm_shufflelo_epi16(alphaHigh, 0xFF), 0xFF);
+
+    __m128i dstLow = _mm_unpacklo_epi8(dst, zero);
+    __m128i dstHigh = _mm_unpackhi_epi8(dst, zero);
+    __m128i low = _mm_add_epi16(_mm_mullo_epi16(srcLow, alphaLow), _mm_mullo_epi16(dstLow, _mm_sub_epi16(full, alphaLow)));
+    __m128i high = _mm_add_epi16(_mm_mullo_epi16(srcHigh, alphaHigh), _mm_mullo_epi16(dstHigh, _mm_sub_epi16(full, alphaHigh)));
+
+    return _mm_packus_epi16(sse2Div255(low), sse2Div255(high));
+}
+
+__attribute__((target("sse2"))) static void sse2Fill(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+    scalarFill(dst + i, count - i, color);
+}
+
+__attribute__((target("sse2"))) static void sse2FillBlend(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    __m128i source = _mm_set1_epi32(static_cast<int>(color));
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128i *address = reinterpret_cast<__m128i*>(dst + i);
+        _mm_storeu_si128(address, sse2Blend(_mm_loadu_si128(address), source));
+    }
+    scalarFillBlend(dst + i, count - i, color);
+}
+
+__attribute__((target("sse2"))) static void sse2CopyBlend(std::uint32_t *dst, const std::uint32_t *src, std::size_t count){
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128i *address = reinterpret_cast<__m128i*>(dst + i);
+        __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(address, sse2Blend(_mm_loadu_si128(address), source));
+    }
+    scalarCopyBlend(dst + i, src + i, count - i);
+}
+
+// Four cells per step, the prefix sum is two shifted adds and integer, so it matches scalar exactly.
+__attribute__((target("sse2"))) static std::int32_t sse2Coverage(const std::int32_t *cells, std::uint8_t *alpha, std::size_t count, std::int32_t sum){
+    const __m128i one = _mm_set1_epi32(COVERAGE_ONE);
+    const __m128i half = _mm_set1_epi32(COVERAGE_ONE >> 1);
+    __m128i offset = _mm_set1_epi32(sum);
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, offset);
+        offset = _mm_shuffle_epi32(x, 0xFF);
+
+        __m128i sign = _mm_srai_epi32(x, 31);
+        __m128i covered = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+        __m128i isOver = _mm_cmpgt_epi32(covered, one);
+        covered = _mm_or_si128(_mm_and_si128(isOver, one), _mm_andnot_si128(isOver, covered));
+        covered = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(covered, 8), covered), half), 16);
+
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(covered, covered), covered);
+        std::int32_t bytes = _mm_cvtsi128_si32(packed);
+        std::memcpy(alpha + i, &bytes, 4);
+    }
+
+    return scalarCoverage(cells + i, alpha + i, count - i, _mm_cvtsi128_si32(offset));
+}
+
+/* AVX2 Kernels */
+__attribute__((target("avx2"))) static inline __m256i avx2Div255(__m256i x){
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Unpacking and packing both work within 128-bit halves, so the pixel order is preserved.
+__attribute__((target("avx2"))) static inline __m256i avx2Blend(__m256i dst, __m256i src){
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    const __m256i full = _mm256_set1_epi16(255);
+    __m256i source = _mm256_or_si256(src, alphaMask);
+
+    __m256i srcLow = _mm256_unpacklo_epi8(source, zero);
+    __m256i srcHigh = _mm256_unpackhi_epi8(source, zero);
+    __m256i alphaLow = _mm256_unpacklo_epi8(src, zero);
+    __m256i alphaHigh = _mm256_unpackhi_epi8(src, zero);
+    alphaLow = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(alphaLow, 0xFF), 0xFF);
+    alphaHigh = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(alphaHigh, 0xFF), 0xFF);
+
+    __m256i dstLow = _mm256_unpacklo_epi8(dst, zero);
+    __m256i dstHigh = _mm256_unpackhi_epi8(dst, zero);
+    __m256i low = _mm256_add_epi16(_mm256_mullo_epi16(srcLow, alphaLow), _mm256_mullo_epi16(dstLow, _mm256_sub_epi16(full, alphaLow)));
+    __m256i high = _mm256_add_epi16(_mm256_mullo_epi16(srcHigh, alphaHigh), _mm256_mullo_epi16(dstHigh, _mm256_sub_epi16(full, alphaHigh)));
+
+    return _mm256_packus_epi16(avx2Div255(low), avx2Div255(high));
+}
+
+__attribute__((target("avx2"))) static void avx2Fill(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    __m256i value = _mm256_set1_epi32(static_cast<int>(color));
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+    scalarFill(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2"))) static void avx2FillBlend(std::uint32_t *dst, std::size_t count, std::uint32_t color){
+    __m256i source = _mm256_set1_epi32(static_cast<int>(color));
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256i *address = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(address, avx2Blend(_mm256_loadu_si256(address), source));
+    }
+    scalarFillBlend(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2"))) static void avx2CopyBlend(std::uint32_t *dst, const std::uint32_t *src, std::size_t count){
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256i *address = reinterpret_cast<__m256i*>(dst + i);
+        __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(address, avx2Blend(_mm256_loadu_si256(address), source));
+    }
+    scalarCopyBlend(dst + i, src + i, count - i);
+}
+#endif
+
+// Helper Functions
+const PixelKernels &scalarKernels(){
+    static const PixelKernels kernels = {"scalar", scalarFill, scalarFillBlend, scalarCopy, scalarCopyBlend, scalarCoverage};
+    return kernels;
+}
+
+std::vector<const PixelKernels*> availableKernels(){
+    std::vector<const PixelKernels*> kernels = {&scalarKernels()};
+
+#ifdef CANVAS_X86_KERNELS
+    // Plain copies are already vectorised by memmove, so only fills and blends get their own. A
+    // prefix sum does not gain from 256-bit lanes, AVX2 reuses the SSE2 coverage kernel.
+    static const PixelKernels sse2 = {"sse2", sse2Fill, sse2FillBlend, scalarCopy, sse2CopyBlend, sse2Coverage};
+    static const PixelKernels avx2 = {"avx2", avx2Fill, avx2FillBlend, scalarCopy, avx2CopyBlend, sse2Coverage};
+
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2")){
+        kernels.emplace_back(&sse2);
+    }
+    if(__builtin_cpu_supports("avx2")){
+        kernels.emplace_back(&avx2);
+    }
+#endif
+
+    return kernels;
+}
+
+const PixelKernels &activeKernels(){
+    static const PixelKernels &kernels = *availableKernels().back();
+    return kernels;
+}
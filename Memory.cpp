@@ -0,0 +1,149 @@
+#include "headers/Memory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+struct AtomicUsage{
+    // Variables
+    std::atomic<std::int64_t> current{0};
+    std::atomic<std::int64_t> peak{0};
+    std::atomic<std::int64_t> allocations{0};
+};
+
+const std::size_t MEMORY_CATEGORIES = static_cast<std::size_t>(MemoryCategory::COUNT);
+
+// Threads count into plain per thread counters and publish them to the shared atomics once 64KiB
+// were allocated or freed since the last time, so the figures of other threads lag by at most that
+// much each. Atomic updates on every allocation doubled the time of call heavy scripts.
+const std::int64_t MEMORY_PUBLISH_BYTES = 64 * 1024;
+
+// Constant initialised, allocations can happen before any dynamic initialisation.
+static AtomicUsage categoryUsage[MEMORY_CATEGORIES];
+static AtomicUsage totalUsage;
+static thread_local MemoryCategory currentCategory = MemoryCategory::OTHER;
+
+static void publishUsage(AtomicUsage &usage, std::int64_t bytes, std::int64_t allocations){
+    std::int64_t current = usage.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::int64_t peak = usage.peak.load(std::memory_order_relaxed);
+    while(current > peak && !usage.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)){}
+    usage.allocations.fetch_add(allocations, std::memory_order_relaxed);
+}
+
+struct ThreadMemory{
+    // Variables
+    std::int64_t bytes[MEMORY_CATEGORIES] = {};
+    std::int64_t allocations[MEMORY_CATEGORIES] = {};
+    std::int64_t traffic = 0;
+    bool isAlive = true;
+
+    // Constructor & Destructor
+    ~ThreadMemory(){
+        publish();
+        isAlive = false;
+    }
+
+    // Functions
+    void publish(){
+        std::int64_t totalBytes = 0, totalAllocations = 0;
+        for(std::size_t i = 0; i < MEMORY_CATEGORIES; ++i){
+            if(bytes[i] != 0 || allocations[i] != 0){
+                publishUsage(categoryUsage[i], bytes[i], allocations[i]);
+                totalBytes += bytes[i];
+                totalAllocations += allocations[i];
+                bytes[i] = 0;
+                allocations[i] = 0;
+            }
+        }
+        publishUsage(totalUsage, totalBytes, totalAllocations);
+        traffic = 0;
+    }
+
+    void add(MemoryCategory category, std::int64_t size, std::int64_t count){
+        // Frees during thread exit, after the destructor ran, go to the atomics directly.
+        if(!isAlive){
+            publishUsage(categoryUsage[static_cast<std::size_t>(category)], size, count);
+            publishUsage(totalUsage, size, count);
+            return;
+        }
+
+        bytes[static_cast<std::size_t>(category)] += size;
+        allocations[static_cast<std::size_t>(category)] += count;
+        traffic += size < 0 ? -size : size;
+        if(traffic >= MEMORY_PUBLISH_BYTES){
+            publish();
+        }
+    }
+};
+
+static thread_local ThreadMemory threadMemory;
+
+/* MemoryScope Class */
+// Constructor & Destructor
+MemoryScope::MemoryScope(MemoryCategory category) : m_previous(currentCategory){
+    currentCategory = category;
+}
+
+MemoryScope::~MemoryScope(){
+    currentCategory = m_previous;
+}
+
+// Helper Functions
+MemoryCategory currentMemoryCategory(){
+    return currentCategory;
+}
+
+void countMemory(MemoryCategory category, std::int64_t bytes, std::int64_t allocations){
+    threadMemory.add(category, bytes, allocations);
+}
+
+const char *memoryCategoryName(MemoryCategory category){
+    switch(category){
+    case MemoryCategory::TOKENS:
+        return "tokens";
+    case MemoryCategory::AST:
+        return "ast";
+    case MemoryCategory::SCOPES:
+        return "scopes";
+    case MemoryCategory::VALUES:
+        return "values";
+    case MemoryCategory::OBJECTS:
+        return "objects";
+    case MemoryCategory::PIXELS:
+        return "pixels";
+    default:
+        return "other";
+    }
+}
+
+// Publishes the calling thread first, so its own figures are exact.
+static MemoryUsage loadUsage(const AtomicUsage &usage){
+    threadMemory.publish();
+    return MemoryUsage{
+        static_cast<std::size_t>(std::max<std::int64_t>(usage.current.load(std::memory_order_relaxed), 0)),
+        static_cast<std::size_t>(usage.peak.load(std::memory_order_relaxed)),
+        static_cast<std::size_t>(usage.allocations.load(std::memory_order_relaxed))
+    };
+}
+
+MemoryUsage memoryUsage(MemoryCategory category){
+    return loadUsage(categoryUsage[static_cast<std::size_t>(category)]);
+}
+
+MemoryUsage totalMemoryUsage(){
+    return loadUsage(totalUsage);
+}
+
+void writeMemoryReport(std::ostream &stream){
+    auto writeLine = [&](const char *name, const MemoryUsage &usage){
+        stream << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(16) << usage.current / 1024.0 << std::setw(16) << usage.peak / 1024.0 << std::setw(16) << usage.allocations << '\n';
+    };
+
+    stream << "\nMemory" << std::setw(22) << "current KiB" << std::setw(16) << "peak KiB" << std::setw(16) << "allocations" << '\n';
+    for(std::size_t i = 0; i < static_cast<std::size_t>(MemoryCategory::COUNT); ++i){
+        writeLine(memoryCategoryName(static_cast<MemoryCategory>(i)), memoryUsage(static_cast<MemoryCategory>(i)));
+    }
+    // The total peak is the highest sum reached, not the sum of the category peaks.
+    writeLine("total", totalMemoryUsage());
+    stream << std::defaultfloat << std::flush;
+}
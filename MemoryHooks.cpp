@@ -0,0 +1,74 @@
+#include "headers/Memory.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete to account every allocation, see Memory.hpp.
+
+// Every block starts with a header holding its size and category, padded so the memory after it
+// keeps the alignment operator new guarantees.
+struct AllocationHeader{
+    // Variables
+    std::size_t size;
+    MemoryCategory category;
+};
+
+static constexpr std::size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+static_assert(sizeof(AllocationHeader) <= ALLOCATION_HEADER_SIZE, "Allocation header too large.");
+
+static void *account(void *block, std::size_t offset, std::size_t size){
+    char *memory = static_cast<char*>(block) + offset;
+    AllocationHeader *header = reinterpret_cast<AllocationHeader*>(memory - ALLOCATION_HEADER_SIZE);
+    header->size = size;
+    header->category = currentMemoryCategory();
+
+    countMemory(header->category, static_cast<std::int64_t>(size), 1);
+    return memory;
+}
+
+static void unaccount(void *memory){
+    AllocationHeader *header = reinterpret_cast<AllocationHeader*>(static_cast<char*>(memory) - ALLOCATION_HEADER_SIZE);
+    countMemory(header->category, -static_cast<std::int64_t>(header->size), 0);
+}
+
+void *operator new(std::size_t size){
+    void *block = std::malloc(size + ALLOCATION_HEADER_SIZE);
+    if(block == nullptr){
+        throw std::bad_alloc();
+    }
+
+    return account(block, ALLOCATION_HEADER_SIZE, size);
+}
+
+void operator delete(void *memory) noexcept{
+    if(memory != nullptr){
+        unaccount(memory);
+        std::free(static_cast<char*>(memory) - ALLOCATION_HEADER_SIZE);
+    }
+}
+
+void operator delete(void *memory, std::size_t) noexcept{
+    operator delete(memory);
+}
+
+// Over-aligned blocks put the header in the last bytes of a whole alignment unit before them.
+void *operator new(std::size_t size, std::align_val_t alignment){
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), ALLOCATION_HEADER_SIZE);
+    void *block = std::aligned_alloc(align, (size + align + align - 1) / align * align);
+    if(block == nullptr){
+        throw std::bad_alloc();
+    }
+
+    return account(block, align, size);
+}
+
+void operator delete(void *memory, std::align_val_t alignment) noexcept{
+    if(memory != nullptr){
+        unaccount(memory);
+        std::free(static_cast<char*>(memory) - std::max(static_cast<std::size_t>(alignment), ALLOCATION_HEADER_SIZE));
+    }
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t alignment) noexcept{
+    operator delete(memory, alignment);
+}
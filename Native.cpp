@@ -0,0 +1,12 @@
+#include "headers/Native.hpp"
+
+/* NativeRegistry Class */
+// Functions
+void NativeRegistry::add(const std::string &name, NativeFunction function){
+    m_functions[name] = std::move(function);
+}
+
+const NativeFunction *NativeRegistry::find(const std::string &name) const{
+    auto found = m_functions.find(name);
+    return found == m_functions.end() ? nullptr : &found->second;
+}
@@ -0,0 +1,213 @@
+#include "headers/Profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
+/* Profiler Class */
+// Constructor & Destructor
+Profiler::Profiler(ProfileMode mode, std::size_t maxCallDepth, int intervalUs) : m_depth(1){
+    m_mode = mode;
+    m_interval = std::chrono::microseconds(std::max(intervalUs, 50));
+    m_capacity = maxCallDepth + 1;
+    m_frames = std::make_unique<std::atomic<std::uint64_t>[]>(m_capacity);
+    m_names.emplace_back("main");
+    m_functions.resize(1);
+    m_functions[0].calls = 1;
+}
+
+Profiler::~Profiler(){
+    stop();
+}
+
+// Functions
+void Profiler::start(){
+    if(m_isRunning){
+        return;
+    }
+
+    m_isRunning = true;
+    m_startTime = std::chrono::steady_clock::now();
+    m_calls.assign(1, ActiveCall{m_startTime, 0.0});
+    m_sampler = std::thread([this](){
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(!m_condition.wait_for(lock, m_interval, [this](){ return !m_isRunning; })){
+            sample();
+        }
+    });
+}
+
+void Profiler::stop(){
+    if(!m_sampler.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_condition.notify_all();
+    m_sampler.join();
+
+    m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    m_functions[0].inclusive = m_seconds;
+    if(m_mode == ProfileMode::INSTRUMENT && !m_calls.empty()){
+        m_functions[0].self += m_seconds - m_calls.front().children;
+    }
+}
+
+void Profiler::enter(const std::string &name){
+    auto found = m_ids.find(name);
+    if(found == m_ids.end()){
+        found = m_ids.emplace(name, static_cast<std::uint32_t>(m_names.size())).first;
+        m_names.emplace_back(name);
+        m_functions.emplace_back();
+    }
+
+    m_topId = found->second;
+    FunctionTiming &function = m_functions[m_topId];
+    ++function.calls;
+    if(m_mode == ProfileMode::INSTRUMENT){
+        ++function.active;
+        m_calls.emplace_back(ActiveCall{std::chrono::steady_clock::now(), 0.0});
+    }
+
+    if(m_top + 1 < m_capacity){
+        ++m_top;
+        m_frames[m_top].store(static_cast<std::uint64_t>(m_topId) << 32, std::memory_order_relaxed);
+        m_depth.store(m_top + 1, std::memory_order_release);
+    }
+}
+
+void Profiler::leave(){
+    if(m_top == 0){
+        return;
+    }
+
+    if(m_mode == ProfileMode::INSTRUMENT && m_calls.size() > 1){
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_calls.back().start).count();
+        FunctionTiming &function = m_functions[m_topId];
+        function.self += elapsed - m_calls.back().children;
+        // Recursive calls count once towards the inclusive time, with the outermost one.
+        if(--function.active == 0){
+            function.inclusive += elapsed;
+        }
+        m_calls.pop_back();
+        m_calls.back().children += elapsed;
+    }
+
+    --m_top;
+    m_depth.store(m_top + 1, std::memory_order_release);
+    m_topId = static_cast<std::uint32_t>(m_frames[m_top].load(std::memory_order_relaxed) >> 32);
+}
+
+// Runs on the sampler thread. The interpreter may change the stack meanwhile, which at worst mixes
+// two neighbouring stacks in one sample.
+void Profiler::sample(){
+    static thread_local std::vector<std::uint64_t> stack;
+    std::size_t depth = std::min(m_depth.load(std::memory_order_acquire), m_capacity);
+    stack.resize(depth);
+    for(std::size_t i = 0; i < depth; ++i){
+        stack[i] = m_frames[i].load(std::memory_order_relaxed);
+    }
+
+    auto found = m_stacks.find(stack);
+    if(found != m_stacks.end()){
+        ++found->second;
+    }else{
+        m_stacks.emplace(stack, 1);
+    }
+    ++m_samples;
+}
+
+std::string Profiler::frameName(std::uint64_t frame) const{
+    std::size_t id = static_cast<std::size_t>(frame >> 32);
+    const std::string &name = id < m_names.size() ? m_names[id] : "?";
+    // Row 0 is a call still binding its arguments, or the script before its first statement.
+    std::uint32_t row = static_cast<std::uint32_t>(frame);
+    return row == 0 ? name : name + ":" + std::to_string(row);
+}
+
+// One line per distinct stack, "main:12;draw:4;shade:9 37", the format flamegraph.pl and
+// speedscope read.
+void Profiler::writeCollapsed(std::ostream &stream) const{
+    std::map<std::string, std::size_t> lines;
+    for(auto &e : m_stacks){
+        std::string line;
+        for(std::uint64_t frame : e.first){
+            line += (line.empty() ? "" : ";") + frameName(frame);
+        }
+        lines[line] += e.second;
+    }
+
+    for(auto &e : lines){
+        stream << e.first << ' ' << e.second << '\n';
+    }
+}
+
+void Profiler::writeReport(std::ostream &stream, std::size_t topCount) const{
+    // Self samples go to the innermost frame, total samples to every function and line on the
+    // stack, counted once per sample however deep they recurse.
+    std::vector<std::size_t> selfSamples(m_names.size()), totalSamples(m_names.size());
+    std::map<std::uint64_t, std::pair<std::size_t, std::size_t>> lineSamples;
+    for(auto &e : m_stacks){
+        std::set<std::uint32_t> functions;
+        std::set<std::uint64_t> lines;
+        for(std::uint64_t frame : e.first){
+            std::uint32_t id = static_cast<std::uint32_t>(frame >> 32);
+            if(id < m_names.size() && functions.insert(id).second){
+                totalSamples[id] += e.second;
+            }
+            if(lines.insert(frame).second){
+                lineSamples[frame].second += e.second;
+            }
+        }
+
+        if(!e.first.empty()){
+            std::uint32_t id = static_cast<std::uint32_t>(e.first.back() >> 32);
+            if(id < m_names.size()){
+                selfSamples[id] += e.second;
+            }
+            lineSamples[e.first.back()].first += e.second;
+        }
+    }
+
+    double samples = std::max<double>(m_samples, 1.0);
+    bool isInstrumented = m_mode == ProfileMode::INSTRUMENT;
+    stream << "\nProfile: " << m_samples << " samples every " << m_interval.count() << "us over " << std::fixed << std::setprecision(3) << m_seconds << "s\n";
+
+    std::vector<std::size_t> order(m_names.size());
+    for(std::size_t i = 0; i < order.size(); ++i){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){
+        return selfSamples[a] != selfSamples[b] ? selfSamples[a] > selfSamples[b] : totalSamples[a] > totalSamples[b];
+    });
+
+    stream << std::left << std::setw(24) << "function" << std::right << std::setw(12) << "calls" << std::setw(10) << "self %" << std::setw(10) << "total %";
+    if(isInstrumented){
+        stream << std::setw(12) << "self ms" << std::setw(12) << "total ms";
+    }
+    stream << '\n';
+    for(std::size_t i = 0; i < std::min(topCount, order.size()); ++i){
+        std::size_t id = order[i];
+        const FunctionTiming &function = m_functions[id];
+        stream << std::left << std::setw(24) << m_names[id] << std::right << std::setw(12) << function.calls << std::setprecision(1)
+            << std::setw(10) << selfSamples[id] * 100.0 / samples << std::setw(10) << totalSamples[id] * 100.0 / samples;
+        if(isInstrumented){
+            stream << std::setprecision(2) << std::setw(12) << function.self * 1e3 << std::setw(12) << function.inclusive * 1e3;
+        }
+        stream << '\n';
+    }
+
+    std::vector<std::pair<std::uint64_t, std::pair<std::size_t, std::size_t>>> lines(lineSamples.begin(), lineSamples.end());
+    std::sort(lines.begin(), lines.end(), [](const auto &a, const auto &b){
+        return a.second.first != b.second.first ? a.second.first > b.second.first : a.second.second > b.second.second;
+    });
+
+    stream << '\n' << std::left << std::setw(24) << "line" << std::right << std::setw(22) << "self %" << std::setw(10) << "total %" << '\n';
+    for(std::size_t i = 0; i < std::min(topCount, lines.size()); ++i){
+        stream << std::left << std::setw(24) << frameName(lines[i].first) << std::right << std::setprecision(1)
+            << std::setw(22) << lines[i].second.first * 100.0 / samples << std::setw(10) << lines[i].second.second * 100.0 / samples << '\n';
+    }
+    stream << std::defaultfloat << std::flush;
+}
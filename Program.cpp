@@ -0,0 +1,47 @@
+#include "headers/Program.hpp"
+#include "headers/AST.hpp"
+
+/* Program Class */
+// Constructor & Destructor
+Program::Program(std::shared_ptr<AbstractNode> root, std::shared_ptr<const std::string> code) : m_root(std::move(root)), m_code(std::move(code)){}
+
+// Functions
+// Functions point into the tree that defined them, so the scope keeps it and its source, which
+// also lets snapshot() save them. A program is added once however often it runs.
+void Program::load(ScopeManager &scope) const{
+    auto isLoaded = [&](const LoadedSource &source){ return source.root == m_root; };
+    if(std::none_of(scope.sources.begin(), scope.sources.end(), isLoaded)){
+        scope.sources.emplace_back(LoadedSource{m_code, m_root});
+    }
+}
+
+// The statements run in the global scope of the scope rather than a block of their own, so what
+// they define is still there once the run returned.
+void Program::run(ScopeManager &scope, const Bindings &bindings) const{
+    load(scope);
+
+    for(auto &e : bindings){
+        if(Data *data = scope.findData(e.first)){
+            *data = e.second;
+        }else{
+            scope.pushData(e.first, e.second);
+        }
+    }
+
+    MemoryScope memory(MemoryCategory::VALUES);
+    for(auto &e : m_root->getChildrens()){
+        if(scope.profiler != nullptr){
+            scope.profiler->line(e->row);
+        }
+        e->eval(scope);
+
+        if(scope.completion != Completion::NORMAL){
+            break;
+        }
+    }
+    scope.completion = Completion::NORMAL;
+}
+
+const std::vector<std::shared_ptr<AbstractNode>> &Program::getStatements() const{
+    return m_root->getChildrens();
+}
@@ -0,0 +1,353 @@
+#include "headers/Raster.hpp"
+#include "headers/Kernels.hpp"
+#include <cmath>
+
+// Rows accumulated at once, keeps the cell buffer small for tall shapes.
+const int RASTER_BAND_ROWS = 64;
+
+// Largest coordinate in pixels, keeps 24.8 values and their differences inside an int.
+const float RASTER_MAX_COORDINATE = 4194304.0f;
+
+struct RasterEdge{
+    // Variables
+    int x0, y0, x1, y1;
+    int direction;
+};
+
+// Helper Functions
+// Adds the edge with y0 < y1. Parts left of 0 or right of `right` are split off and clamped onto
+// that side, they still open and close the span but cover nothing outside the area.
+static void addEdge(std::vector<RasterEdge> &edges, int x0, int y0, int x1, int y1, int right){
+    if(y0 == y1){
+        return;
+    }
+
+    for(int bound : {0, right}){
+        if((x0 < bound) != (x1 < bound) && x0 != bound && x1 != bound){
+            int y = y0 + static_cast<int>(static_cast<std::int64_t>(bound - x0) * (y1 - y0) / (x1 - x0));
+            addEdge(edges, x0, y0, bound, y, right);
+            addEdge(edges, bound, y, x1, y1, right);
+            return;
+        }
+    }
+
+    x0 = std::clamp(x0, 0, right);
+    x1 = std::clamp(x1, 0, right);
+    if(y0 < y1){
+        edges.push_back(RasterEdge{x0, y0, x1, y1, 1});
+    }else{
+        edges.push_back(RasterEdge{x1, y1, x0, y0, -1});
+    }
+}
+
+static int edgeXAt(const RasterEdge &edge, int y){
+    return edge.x0 + static_cast<int>(static_cast<std::int64_t>(y - edge.y0) * (edge.x1 - edge.x0) / (edge.y1 - edge.y0));
+}
+
+// Deposits the area of one edge segment inside a row. total is its signed height times a pixel
+// width, each cell receives the part of it left of the next cell boundary so that the prefix sum
+// of a row is the covered fraction of every pixel. The last cell takes the remainder, a row always
+// sums to exactly total whatever the rounding.
+static void depositSegment(std::int32_t *cells, int xa, int xb, std::int32_t total, int &rowMin, int &rowMax){
+    if(xa > xb){
+        std::swap(xa, xb);
+    }
+
+    int first = xa >> 8;
+    int last = (xb + 255) >> 8;
+    if(last <= first + 1){
+        std::int32_t right = static_cast<std::int32_t>(static_cast<std::int64_t>(total) * (xa + xb - 2 * (first << 8)) / 512);
+        cells[first] += total - right;
+        cells[first + 1] += right;
+        rowMin = std::min(rowMin, first);
+        rowMax = std::max(rowMax, first + 1);
+        return;
+    }
+
+    double slope = 256.0 / (xb - xa);
+    double firstFraction = (xa - (first << 8)) / 256.0;
+    double lastFraction = (xb - (last << 8)) / 256.0 + 1.0;
+    double firstArea = 0.5 * slope * (1.0 - firstFraction) * (1.0 - firstFraction);
+    double lastArea = 0.5 * slope * lastFraction * lastFraction;
+    auto share = [total](double fraction){
+        return static_cast<std::int32_t>(std::lround(total * fraction));
+    };
+
+    std::int32_t placed = share(firstArea);
+    cells[first] += placed;
+    if(last == first + 2){
+        std::int32_t middle = share(1.0 - firstArea - lastArea);
+        cells[first + 1] += middle;
+        placed += middle;
+    }else{
+        double area = slope * (1.5 - firstFraction);
+        std::int32_t second = share(area - firstArea);
+        cells[first + 1] += second;
+        placed += second;
+
+        std::int32_t step = share(slope);
+        for(int x = first + 2; x < last - 1; ++x){
+            cells[x] += step;
+            placed += step;
+        }
+
+        area += (last - first - 3) * slope;
+        std::int32_t beforeLast = share(1.0 - area - lastArea);
+        cells[last - 1] += beforeLast;
+        placed += beforeLast;
+    }
+    cells[last] += total - placed;
+    rowMin = std::min(rowMin, first);
+    rowMax = std::max(rowMax, last);
+}
+
+// Composites runs of equal alpha, fully covered runs are plain fills.
+static void compositeCoverage(std::uint32_t *dst, const std::uint8_t *alpha, int count, std::uint32_t color){
+    std::uint32_t baseAlpha = colorAlpha(color);
+    int x = 0;
+    while(x < count){
+        std::uint8_t coverage = alpha[x];
+        int end = x + 1;
+        while(end < count && alpha[end] == coverage){
+            ++end;
+        }
+
+        if(coverage == 255){
+            fillSpan(dst + x, end - x, color);
+        }else if(coverage != 0){
+            fillSpan(dst + x, end - x, (color & 0x00FFFFFF) | (div255(baseAlpha * coverage) << 24));
+        }
+        x = end;
+    }
+}
+
+static void orientContour(Contour &contour){
+    std::int64_t area = 0;
+    for(std::size_t i = 0; i < contour.size(); ++i){
+        const FixedPoint &a = contour[i];
+        const FixedPoint &b = contour[(i + 1) % contour.size()];
+        area += static_cast<std::int64_t>(a.x) * b.y - static_cast<std::int64_t>(b.x) * a.y;
+    }
+
+    if(area < 0){
+        std::reverse(contour.begin(), contour.end());
+    }
+}
+
+void fillContours(CanvasObject &canvas, const std::vector<Contour> &contours, std::uint32_t color, const ClipRect &clip){
+    if(colorAlpha(color) == 0){
+        return;
+    }
+
+    int minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+    for(const Contour &contour : contours){
+        for(const FixedPoint &point : contour){
+            minX = std::min(minX, point.x);
+            minY = std::min(minY, point.y);
+            maxX = std::max(maxX, point.x);
+            maxY = std::max(maxY, point.y);
+        }
+    }
+
+    if(minX > maxX){
+        return;
+    }
+
+    ClipRect shape{minX >> 8, minY >> 8, (maxX + 255) >> 8, (maxY + 255) >> 8};
+    ClipRect area = intersect(shape, canvas.bounds());
+    ClipRect visible = intersect(area, clip);
+    if(visible.x0 >= visible.x1 || visible.y0 >= visible.y1){
+        return;
+    }
+
+    // Rows are independent, but edges are clamped onto the sides of the area, so only the rows are
+    // narrowed to the clip and the columns are cut when compositing. A shape split into tiles then
+    // gets exactly the pixels it gets drawn whole.
+    area.y0 = visible.y0;
+    area.y1 = visible.y1;
+
+    int areaWidth = area.x1 - area.x0;
+    int areaHeight = area.y1 - area.y0;
+    int offsetX = area.x0 * RASTER_SUBPIXELS;
+    int offsetY = area.y0 * RASTER_SUBPIXELS;
+
+    std::vector<RasterEdge> edges;
+    for(const Contour &contour : contours){
+        if(contour.size() < 3){
+            continue;
+        }
+
+        for(std::size_t i = 0; i < contour.size(); ++i){
+            const FixedPoint &a = contour[i];
+            const FixedPoint &b = contour[(i + 1) % contour.size()];
+            addEdge(edges, a.x - offsetX, a.y - offsetY, b.x - offsetX, b.y - offsetY, areaWidth * RASTER_SUBPIXELS);
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const RasterEdge &a, const RasterEdge &b){
+        return a.y0 < b.y0;
+    });
+
+    // Cells run one past the last pixel so a segment on the right side has somewhere to put its
+    // remainder.
+    int bandRows = std::min(RASTER_BAND_ROWS, areaHeight);
+    std::size_t cellStride = static_cast<std::size_t>(areaWidth) + 2;
+    std::vector<std::int32_t> cells(cellStride * bandRows, 0);
+    std::vector<std::uint8_t> alpha(areaWidth);
+    std::vector<int> rowMin(bandRows), rowMax(bandRows);
+    const PixelKernels &kernels = activeKernels();
+
+    std::size_t firstEdge = 0;
+    for(int bandTop = 0; bandTop < areaHeight; bandTop += bandRows){
+        int bandBottom = std::min(bandTop + bandRows, areaHeight);
+        std::fill(rowMin.begin(), rowMin.end(), INT32_MAX);
+        std::fill(rowMax.begin(), rowMax.end(), -1);
+
+        while(firstEdge < edges.size() && edges[firstEdge].y1 <= bandTop * RASTER_SUBPIXELS){
+            ++firstEdge;
+        }
+
+        for(std::size_t i = firstEdge; i < edges.size(); ++i){
+            const RasterEdge &edge = edges[i];
+            if(edge.y0 >= bandBottom * RASTER_SUBPIXELS){
+                break;
+            }
+            if(edge.y1 <= bandTop * RASTER_SUBPIXELS){
+                continue;
+            }
+
+            int rowStart = std::max(bandTop, edge.y0 >> 8);
+            int rowEnd = std::min(bandBottom, (edge.y1 + 255) >> 8);
+            for(int y = rowStart; y < rowEnd; ++y){
+                int top = std::max(y * RASTER_SUBPIXELS, edge.y0);
+                int bottom = std::min((y + 1) * RASTER_SUBPIXELS, edge.y1);
+                if(top >= bottom){
+                    continue;
+                }
+
+                std::int32_t total = (bottom - top) * RASTER_SUBPIXELS * edge.direction;
+                int row = y - bandTop;
+                depositSegment(cells.data() + row * cellStride, edgeXAt(edge, top), edgeXAt(edge, bottom), total, rowMin[row], rowMax[row]);
+            }
+        }
+
+        for(int row = 0; row < bandBottom - bandTop; ++row){
+            std::int32_t *rowCells = cells.data() + row * cellStride;
+            if(rowMax[row] < 0){
+                continue;
+            }
+
+            int start = rowMin[row];
+            if(start < areaWidth){
+                int end = std::min(areaWidth, rowMax[row] + 1);
+                std::int32_t sum = kernels.coverage(rowCells + start, alpha.data() + start, end - start, 0);
+                std::uint8_t tail = coverageToAlpha(sum);
+                if(tail != 0){
+                    std::fill(alpha.begin() + end, alpha.end(), tail);
+                    end = areaWidth;
+                }
+
+                int first = std::max(start, visible.x0 - area.x0);
+                int last = std::min(end, visible.x1 - area.x0);
+                if(first < last){
+                    compositeCoverage(canvas.row(area.y0 + bandTop + row) + area.x0 + first, alpha.data() + first, last - first, color);
+                }
+            }
+            std::fill(rowCells + start, rowCells + rowMax[row] + 1, 0);
+        }
+    }
+}
+
+FixedPoint toFixedPoint(float x, float y){
+    auto convert = [](float value){
+        if(std::isnan(value)){
+            return 0;
+        }
+
+        value = std::clamp(value, -RASTER_MAX_COORDINATE, RASTER_MAX_COORDINATE);
+        return static_cast<int>(std::lround(value * RASTER_SUBPIXELS));
+    };
+
+    return FixedPoint{convert(x), convert(y)};
+}
+
+// Enough segments that the chords stay within a tenth of a pixel of the true circle.
+Contour circleContour(float cx, float cy, float radius, bool isReversed){
+    Contour contour;
+    if(!(radius > 0.0f)){
+        return contour;
+    }
+
+    const float tolerance = 0.1f;
+    int segments = 8;
+    if(radius > tolerance){
+        double step = 2.0 * std::acos(1.0 - tolerance / radius);
+        segments = std::clamp(static_cast<int>(std::ceil(2.0 * M_PI / step)), 8, 4096);
+    }
+
+    // The vertices sit slightly outside the circle so the polygon has the same area as it.
+    double vertexRadius = radius * std::sqrt(2.0 * M_PI / (segments * std::sin(2.0 * M_PI / segments)));
+    contour.reserve(segments);
+    for(int i = 0; i < segments; ++i){
+        double angle = 2.0 * M_PI * i / segments;
+        contour.push_back(toFixedPoint(cx + vertexRadius * std::cos(angle), cy + vertexRadius * std::sin(angle)));
+    }
+
+    orientContour(contour);
+    if(isReversed){
+        std::reverse(contour.begin(), contour.end());
+    }
+
+    return contour;
+}
+
+Contour polygonContour(const std::vector<float> &coordinates){
+    Contour contour;
+    contour.reserve(coordinates.size() / 2);
+    for(std::size_t i = 0; i + 1 < coordinates.size(); i += 2){
+        contour.push_back(toFixedPoint(coordinates[i], coordinates[i + 1]));
+    }
+
+    return contour;
+}
+
+// One quad per segment and a round join at every vertex where two segments meet, ends are butt.
+std::vector<Contour> strokeContours(const std::vector<float> &coordinates, float width, bool isClosed){
+    std::vector<Contour> contours;
+    std::vector<std::pair<float, float>> points;
+    for(std::size_t i = 0; i + 1 < coordinates.size(); i += 2){
+        if(points.empty() || points.back().first != coordinates[i] || points.back().second != coordinates[i + 1]){
+            points.emplace_back(coordinates[i], coordinates[i + 1]);
+        }
+    }
+
+    if(isClosed && points.size() > 2 && points.front() == points.back()){
+        points.pop_back();
+    }
+
+    float half = width * 0.5f;
+    if(points.size() < 2 || !(half > 0.0f)){
+        return contours;
+    }
+
+    std::size_t segments = isClosed && points.size() > 2 ? points.size() : points.size() - 1;
+    for(std::size_t i = 0; i < segments; ++i){
+        auto [x0, y0] = points[i];
+        auto [x1, y1] = points[(i + 1) % points.size()];
+        float length = std::hypot(x1 - x0, y1 - y0);
+        float nx = -(y1 - y0) / length * half;
+        float ny = (x1 - x0) / length * half;
+
+        Contour quad{toFixedPoint(x0 + nx, y0 + ny), toFixedPoint(x1 + nx, y1 + ny), toFixedPoint(x1 - nx, y1 - ny), toFixedPoint(x0 - nx, y0 - ny)};
+        orientContour(quad);
+        contours.push_back(std::move(quad));
+    }
+
+    std::size_t firstJoin = segments == points.size() ? 0 : 1;
+    std::size_t lastJoin = segments == points.size() ? points.size() : points.size() - 1;
+    for(std::size_t i = firstJoin; i < lastJoin; ++i){
+        contours.push_back(circleContour(points[i].first, points[i].second, half));
+    }
+
+    return contours;
+}
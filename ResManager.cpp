@@ -1,4 +1,5 @@
 #include "headers/ResManager.hpp"
+#include "headers/Error.hpp"
 /* SymbolTable Class */
 // Variables
 // Constructor & Destructor
@@ -6,21 +7,85 @@ SymbolTable::SymbolTable(std::shared_ptr<SymbolTable> m_parent){
     this->m_parent = m_parent;
 }
 
+SymbolTable::~SymbolTable(){
+    for(auto &e : m_openUpvalues){
+        e.second.as<UpvalueObject>()->close();
+    }
+}
+
 // Functions
 void SymbolTable::push(const std::string& name, const Data& value){
+    MemoryScope memory(MemoryCategory::SCOPES);
+    CANVAS_STAT_STRING(value);
     m_table[name] = value;
 }
 
 Data *SymbolTable::find(const std::string& name, SymbolSearchType type){
-    if(m_table.find(name) != m_table.end()){
-        return &m_table[name];
-    }else if(m_parent != nullptr && type == SymbolSearchType::RECURSIVE_SCOPE){
+    auto it = m_table.find(name);
+    if(it != m_table.end()){
+        return &it->second;
+    }
+
+    if(!m_upvalues.empty()){
+        auto upvalueIt = m_upvalues.find(name);
+        if(upvalueIt != m_upvalues.end()){
+            return upvalueIt->second.as<UpvalueObject>()->slot;
+        }
+    }
+
+    if(m_parent != nullptr && type == SymbolSearchType::RECURSIVE_SCOPE){
+        CANVAS_STAT(scopeHops);
         return m_parent->find(name);
     }
 
     return nullptr;
 }
 
+void SymbolTable::bindUpvalue(const std::string &name, const Ref &upvalue){
+    m_upvalues[name] = upvalue;
+}
+
+// Returns the upvalue for the slot `name` resolves to, reusing the one already opened on that
+// slot so every closure capturing the same variable shares it.
+Ref SymbolTable::captureUpvalue(const std::string &name, Heap &heap){
+    auto it = m_table.find(name);
+    if(it != m_table.end()){
+        Ref &upvalue = m_openUpvalues[name];
+        if(!upvalue){
+            upvalue = heap.make<UpvalueObject>(&it->second);
+        }
+
+        return upvalue;
+    }
+
+    auto upvalueIt = m_upvalues.find(name);
+    if(upvalueIt != m_upvalues.end()){
+        return upvalueIt->second;
+    }
+
+    if(m_parent != nullptr){
+        return m_parent->captureUpvalue(name, heap);
+    }
+
+    return Ref();
+}
+
+// True when every variable defined here, upvalues included, is one isListed accepts.
+bool SymbolTable::definesOnly(const std::function<bool(const std::string&)> &isListed) const{
+    for(auto &e : m_table){
+        if(!isListed(e.first)){
+            return false;
+        }
+    }
+    for(auto &e : m_upvalues){
+        if(!isListed(e.first)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
 std::shared_ptr<SymbolTable> SymbolTable::getParent(){
     return m_parent;
 }
@@ -51,7 +116,13 @@ std::shared_ptr<AbstractNode> ScopeManager::findLib(std::string libName){
     return nullptr;
 }
 
+Heap &ScopeManager::getHeap(){
+    return m_heap;
+}
+
 void ScopeManager::pushScope(){
+    CANVAS_STAT(pushScope);
+    MemoryScope memory(MemoryCategory::SCOPES);
     m_currentScope = std::make_shared<SymbolTable>(m_currentScope);
 }
 
@@ -61,11 +132,146 @@ void ScopeManager::popScope(){
     }
 }
 
+std::shared_ptr<SymbolTable> ScopeManager::pushFrame(std::shared_ptr<SymbolTable> parent){
+    std::shared_ptr<SymbolTable> previousScope = m_currentScope;
+    MemoryScope memory(MemoryCategory::SCOPES);
+    m_currentScope = std::make_shared<SymbolTable>(parent);
+
+    return previousScope;
+}
+
+void ScopeManager::popFrame(std::shared_ptr<SymbolTable> previousScope){
+    m_currentScope = previousScope;
+}
+
+std::shared_ptr<SymbolTable> ScopeManager::getCurrentScope(){
+    return m_currentScope;
+}
+
+std::shared_ptr<SymbolTable> ScopeManager::getGlobalScope(){
+    return m_globalScope;
+}
+
+Ref ScopeManager::captureUpvalue(const std::string &name){
+    return m_currentScope->captureUpvalue(name, m_heap);
+}
+
+// Consumes a break or continue after a loop body ran, returns true if the loop has to stop.
+bool ScopeManager::endsLoop(){
+    if(completion == Completion::RETURN){
+        return true;
+    }
+
+    bool isBreaking = completion == Completion::BREAK;
+    completion = Completion::NORMAL;
+
+    return isBreaking;
+}
+
+void ScopeManager::enterCall(const std::string &name){
+    if(callStack.size() >= maxCallDepth){
+        throw Error("~Error~ Maximum call depth of " + std::to_string(maxCallDepth) + " exceeded in \'" + name + "\'.");
+    }
+    step();
+
+    CANVAS_STAT(userCalls);
+    callStack.push_back(CallFrame{name, m_currentScope});
+    if(profiler != nullptr){
+        profiler->enter(name);
+    }
+    if(tracer().isEnabled()){
+        tracer().begin(name, "function");
+    }
+}
+
+void ScopeManager::leaveCall(){
+    callStack.pop_back();
+    if(profiler != nullptr){
+        profiler->leave();
+    }
+    if(tracer().isEnabled()){
+        tracer().end();
+    }
+}
+
+// Drops the calls an error left open and makes the global scope current again, so the scope can
+// run more code after it.
+void ScopeManager::unwind(){
+    callStack.clear();
+    isTailCalling = false;
+    tailCall = TailCall();
+    completion = Completion::NORMAL;
+    popFrame(m_globalScope);
+}
+
+// Restarts the step count and the clock, so a scope running one program after another gives each
+// run the whole budget.
+void ScopeManager::applyLimits(const ExecutionLimits &limits){
+    m_heap.setLimit(limits.maxHeap);
+    if(limits.heapAccount != nullptr){
+        m_heap.shareAccount(limits.heapAccount);
+    }
+    maxCallDepth = limits.maxCallDepth;
+
+    m_steps = 0;
+    m_chargedSteps = 0;
+    m_maxSteps = limits.maxSteps;
+    m_stepAccount = limits.stepAccount;
+    if(m_maxSteps != 0 && m_stepAccount == nullptr){
+        m_stepAccount = std::make_shared<std::atomic<std::uint64_t>>(0);
+    }
+    m_timeout = limits.timeout;
+    m_deadline = limits.timeout.count() > 0 ? std::chrono::steady_clock::now() + limits.timeout : std::chrono::steady_clock::time_point::max();
+    m_nextLimitCheck = 0;
+    checkLimits();
+}
+
+// Limits for an isolate started now: the same depth, what is left of the time, and the heap and
+// steps charged to the accounts of this scope.
+ExecutionLimits ScopeManager::remainingLimits(){
+    ExecutionLimits limits;
+    limits.maxHeap = m_heap.getLimit();
+    if(limits.maxHeap != 0){
+        limits.heapAccount = m_heap.getAccount();
+    }
+    limits.maxCallDepth = maxCallDepth;
+    limits.maxSteps = m_maxSteps;
+    limits.stepAccount = m_stepAccount;
+    if(m_deadline != std::chrono::steady_clock::time_point::max()){
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_deadline - std::chrono::steady_clock::now());
+        limits.timeout = std::max(remaining, std::chrono::milliseconds(1));
+    }
+
+    return limits;
+}
+
+// Steps are charged to the shared account in batches, alone a scope stops exactly after its last
+// allowed step, isolates sharing the account may overrun it by a batch each.
+void ScopeManager::checkLimits(){
+    m_nextLimitCheck = UINT64_MAX;
+    if(m_maxSteps != 0){
+        std::uint64_t used = m_stepAccount->fetch_add(m_steps - m_chargedSteps) + (m_steps - m_chargedSteps);
+        m_chargedSteps = m_steps;
+        if(used > m_maxSteps){
+            throw LimitError("Step limit of " + std::to_string(m_maxSteps) + " exceeded.");
+        }
+        m_nextLimitCheck = m_steps + std::min(m_maxSteps - used + 1, TIMEOUT_CHECK_STEPS);
+    }
+
+    if(m_deadline != std::chrono::steady_clock::time_point::max()){
+        if(std::chrono::steady_clock::now() >= m_deadline){
+            throw LimitError("Time limit of " + std::to_string(m_timeout.count()) + "ms exceeded.");
+        }
+        m_nextLimitCheck = std::min(m_nextLimitCheck, m_steps + TIMEOUT_CHECK_STEPS);
+    }
+}
+
 void ScopeManager::pushData(const std::string &name, const Data &value){
     m_currentScope->push(name, value);
 }
 
 Data *ScopeManager::findData(const std::string &name, SymbolSearchType type){
+    CANVAS_STAT(findData);
     return m_currentScope->find(name, type);
 }
 
@@ -106,4 +312,30 @@ void ScopeManager::debug_outScopes() {
         }
         ++depth;
     }
-}
\ No newline at end of file
+}
+
+/* CallGuard Class */
+// Constructor & Destructor
+CallGuard::CallGuard(ScopeManager &scope, const std::string &name) : m_scope(scope), m_callerScope(scope.getCurrentScope()){
+    m_scope.enterCall(name);
+    m_isEntered = true;
+}
+
+CallGuard::~CallGuard(){
+    m_scope.popFrame(m_callerScope);
+    if(m_isEntered){
+        m_scope.leaveCall();
+    }
+}
+
+// Functions
+void CallGuard::reenter(const std::string &name){
+    m_scope.leaveCall();
+    m_isEntered = false;
+    m_scope.enterCall(name);
+    m_isEntered = true;
+}
+
+std::shared_ptr<SymbolTable> CallGuard::getCallerScope() const{
+    return m_callerScope;
+}
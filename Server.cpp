@@ -0,0 +1,335 @@
+#include "headers/Server.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Helper Functions
+// Braces inside string literals do not count.
+static int braceDepth(const std::string &text){
+    int depth = 0;
+    bool isString = false;
+    for(char e : text){
+        if(e == '\"'){
+            isString = !isString;
+        }else if(!isString && e == '{'){
+            ++depth;
+        }else if(!isString && e == '}'){
+            --depth;
+        }
+    }
+
+    return depth;
+}
+
+static bool isExpression(NodeType type){
+    return type == NodeType::BIN_EXP || type == NodeType::UNR_EXP || type == NodeType::CAL_STM
+        || type == NodeType::IDN || type == NodeType::NUM_LIT || type == NodeType::STR_LIT;
+}
+
+// Runs the statements of one input in the global scope instead of a block of their own. After an
+// error the calls it left open are dropped and the global scope becomes current again.
+static void evaluateInput(Interpreter &interpreter, ScopeManager &scope, const std::string &code){
+    try{
+        std::shared_ptr<const Program> program = interpreter.compile(code);
+        if(program == nullptr){
+            return;
+        }
+
+        program->load(scope);
+        for(auto &e : program->getStatements()){
+            NodeInfo result = identifierToLiteral(e->eval(scope), scope);
+            scope.completion = Completion::NORMAL;
+            if(isExpression(e->info.type) && (result.type == NodeType::NUM_LIT || result.type == NodeType::STR_LIT)){
+                std::cout << variantAsStr(result.data) << std::endl;
+            }
+        }
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        scope.unwind();
+    }catch(const std::exception &e){
+        std::cout << "~Error~ " << e.what() << std::endl;
+        scope.unwind();
+    }
+}
+
+int runRepl(const ExecutionLimits &limits){
+    try{
+        runWithStackSize(nativeStackSizeFor(limits.maxCallDepth), [&](){
+            Interpreter interpreter;
+            ScopeManager scope;
+
+            std::cout << "Canvas REPL, :quit or Ctrl-D to leave." << std::endl;
+            std::string input, line;
+            while(true){
+                std::cout << (input.empty() ? "> " : ". ") << std::flush;
+                if(!std::getline(std::cin, line)){
+                    break;
+                }
+
+                if(input.empty() && (line == ":quit" || line == ":q")){
+                    break;
+                }
+                if(!line.empty() && line[0] == '#'){
+                    continue;
+                }
+
+                input += line + "\n";
+                if(braceDepth(input) > 0){
+                    continue;
+                }
+
+                // A single statement may leave out its ';'.
+                std::size_t last = input.find_last_not_of(" \t\r\n");
+                if(last == std::string::npos){
+                    input.clear();
+                    continue;
+                }
+                if(input[last] != ';' && input[last] != '}'){
+                    input.insert(last + 1, ";");
+                }
+
+                scope.applyLimits(limits);
+                evaluateInput(interpreter, scope, "{\n" + input + "}");
+                input.clear();
+            }
+            std::cout << std::endl;
+        });
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+static bool writeAll(int fd, const std::string &data){
+    std::size_t written = 0;
+    while(written < data.size()){
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if(count < 0 && errno == EINTR){
+            continue;
+        }
+        if(count <= 0){
+            return false;
+        }
+        written += static_cast<std::size_t>(count);
+    }
+
+    return true;
+}
+
+// With a timeout the whole read must finish in time, a client sending slowly is cut off as well.
+static bool readAll(int fd, std::string &data, int timeoutMs = -1){
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char buffer[65536];
+    while(true){
+        if(timeoutMs >= 0){
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            pollfd descriptor = {fd, POLLIN, 0};
+            int ready = remaining.count() > 0 ? poll(&descriptor, 1, static_cast<int>(remaining.count())) : 0;
+            if(ready < 0 && errno == EINTR){
+                continue;
+            }
+            if(ready <= 0){
+                errno = ready == 0 ? ETIMEDOUT : errno;
+                return false;
+            }
+        }
+
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if(count < 0 && errno == EINTR){
+            continue;
+        }
+        if(count < 0){
+            return false;
+        }
+        if(count == 0){
+            return true;
+        }
+        data.append(buffer, static_cast<std::size_t>(count));
+    }
+}
+
+static bool toSocketAddress(const std::string &socketPath, sockaddr_un &address){
+    if(socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)){
+        std::cout << "~Error~ Invalid socket path \'" << socketPath << "\'." << std::endl;
+        return false;
+    }
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+struct ProgramCache{
+    // Variables
+    std::unordered_map<std::string, std::shared_ptr<const Program>> programs;
+    std::deque<std::string> order;
+};
+
+// Runs one script with std::cout captured and returns what it printed, errors included.
+static std::string serveScript(const std::string &source, ProgramCache &cache, const ExecutionLimits &limits){
+    auto startTime = std::chrono::steady_clock::now();
+    std::istringstream stream(source);
+    std::string code = loadSourceAsCode(stream);
+    bool isCached = false;
+
+    std::ostringstream output;
+    std::streambuf *previous = std::cout.rdbuf(output.rdbuf());
+    try{
+        runWithStackSize(nativeStackSizeFor(limits.maxCallDepth), [&](){
+            std::shared_ptr<const Program> program;
+            auto found = cache.programs.find(code);
+            if(found != cache.programs.end()){
+                program = found->second;
+                isCached = true;
+            }else{
+                Interpreter interpreter;
+                program = interpreter.compile(code);
+                cache.programs.emplace(code, program);
+                cache.order.emplace_back(code);
+                if(cache.order.size() > SERVE_PROGRAM_CACHE){
+                    cache.programs.erase(cache.order.front());
+                    cache.order.pop_front();
+                }
+            }
+
+            if(program != nullptr){
+                ScopeManager scope;
+                scope.applyLimits(limits);
+                try{
+                    program->run(scope);
+                }catch(...){
+                    tracer().endScripts();
+                    throw;
+                }
+                tracer().endScripts();
+            }
+        });
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+    }catch(const std::exception &e){
+        std::cout << "~Error~ " << e.what() << std::endl;
+    }
+
+    // The frame sink is global, frames of the next script must not land in this one's sequence.
+    try{
+        frameSink().close();
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+    }
+    std::cout.rdbuf(previous);
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cerr << "Ran " << source.size() << " bytes in " << milliseconds << "ms" << (isCached ? " (cached)" : "") << std::endl;
+    return output.str();
+}
+
+static volatile std::sig_atomic_t isServing = 1;
+
+static void stopServing(int){
+    isServing = 0;
+}
+
+int runServer(const std::string &socketPath, const ExecutionLimits &limits){
+    sockaddr_un address;
+    if(!toSocketAddress(socketPath, address)){
+        return 1;
+    }
+
+    // A socket left behind by an earlier daemon is replaced, any other file is kept.
+    struct stat status;
+    if(lstat(socketPath.c_str(), &status) == 0){
+        if(!S_ISSOCK(status.st_mode)){
+            std::cout << "~Error~ \'" << socketPath << "\' exists and is not a socket." << std::endl;
+            return 1;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(server < 0 || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(server, 16) < 0){
+        std::cout << "~Error~ Could not listen on \'" << socketPath << "\': " << std::strerror(errno) << std::endl;
+        if(server >= 0){
+            close(server);
+        }
+        return 1;
+    }
+
+    // Without SA_RESTART a signal interrupts accept(), the daemon then removes its socket.
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = stopServing;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cerr << "Serving on \'" << socketPath << "\'." << std::endl;
+    ProgramCache cache;
+    while(isServing){
+        int client = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+        if(client < 0){
+            if(errno == EINTR || errno == ECONNABORTED){
+                continue;
+            }
+            std::cout << "~Error~ " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        timeval timeout = {SERVE_CLIENT_TIMEOUT_MS / 1000, (SERVE_CLIENT_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string source;
+        if(readAll(client, source, SERVE_CLIENT_TIMEOUT_MS)){
+            writeAll(client, serveScript(source, cache, limits));
+        }else{
+            std::cerr << "Dropped a client: " << std::strerror(errno) << std::endl;
+        }
+        close(client);
+    }
+
+    close(server);
+    unlink(socketPath.c_str());
+    return 0;
+}
+
+int runClient(const std::string &socketPath, const std::string &fileName){
+    std::ifstream file(fileName, std::ios::binary);
+    if(!file.is_open()){
+        std::cout << "~Error~ Failed to open \'" << fileName << "\'" << std::endl;
+        return 1;
+    }
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    sockaddr_un address;
+    if(!toSocketAddress(socketPath, address)){
+        return 1;
+    }
+
+    int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    std::string reply;
+    bool isSent = connection >= 0 && connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+        && writeAll(connection, source) && shutdown(connection, SHUT_WR) == 0 && readAll(connection, reply);
+    int error = errno;
+    if(connection >= 0){
+        close(connection);
+    }
+
+    if(!isSent){
+        std::cout << "~Error~ Could not run \'" << fileName << "\' on \'" << socketPath << "\': " << std::strerror(error) << std::endl;
+        return 1;
+    }
+
+    std::cout << reply << std::flush;
+    return 0;
+}
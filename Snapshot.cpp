@@ -0,0 +1,394 @@
+#include "headers/Snapshot.hpp"
+#include "headers/AST.hpp"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char SNAPSHOT_MAGIC[8] = {'C', 'N', 'V', 'S', 'N', 'A', 'P', '\0'};
+const std::uint32_t SNAPSHOT_VERSION = 1;
+
+// Helper Functions
+// Nodes of a tree in pre-order, a function is saved as its position in this list. Parsing the
+// same code again gives the same list.
+static void collectNodes(AbstractNode *node, std::vector<AbstractNode*> &nodes){
+    nodes.emplace_back(node);
+    for(auto &e : node->getChildrens()){
+        collectNodes(e.get(), nodes);
+    }
+}
+
+static std::uint64_t alignTo8(std::uint64_t offset){
+    return (offset + 7) & ~static_cast<std::uint64_t>(7);
+}
+
+// Objects get their index when first reached, so shared lists stay shared and closures capturing
+// themselves terminate. Offsets are relative to the data section.
+struct SnapshotBuilder{
+    // Variables
+    ScopeManager &scope;
+    std::unordered_map<const void*, std::pair<std::size_t, std::uint32_t>> nodes;
+    std::unordered_map<const void*, NodeType> nodeTypes;
+    std::unordered_map<std::size_t, std::uint32_t> sourceIndex;
+    std::vector<std::size_t> sources;
+    std::unordered_map<const HeapObject*, std::uint32_t> objectIndex;
+    std::vector<SnapshotObject> objects;
+    std::string data;
+
+    // Constructor & Destructor
+    SnapshotBuilder(ScopeManager &scope) : scope(scope){
+        for(std::size_t i = 0; i < scope.sources.size(); ++i){
+            std::vector<AbstractNode*> sourceNodes;
+            collectNodes(scope.sources[i].root.get(), sourceNodes);
+            for(std::size_t j = 0; j < sourceNodes.size(); ++j){
+                nodes.emplace(static_cast<const void*>(sourceNodes[j]), std::make_pair(i, static_cast<std::uint32_t>(j)));
+                nodeTypes.emplace(static_cast<const void*>(sourceNodes[j]), sourceNodes[j]->info.type);
+            }
+        }
+    }
+
+    // Functions
+    std::uint64_t append(const void *bytes, std::size_t size){
+        std::uint64_t offset = alignTo8(data.size());
+        data.resize(offset);
+        data.append(static_cast<const char*>(bytes), size);
+        return offset;
+    }
+
+    // Returns the source and node a function or lambda is saved as.
+    std::pair<std::uint32_t, std::uint32_t> encodeNode(const void *node, NodeType type, const std::string &name){
+        auto found = nodes.find(node);
+        if(found == nodes.end() || nodeTypes.at(node) != type){
+            throw ParserException("~Error~ \'" + name + "\' holds a function whose source is unknown, it cannot be saved in a snapshot.");
+        }
+
+        auto source = sourceIndex.emplace(found->second.first, static_cast<std::uint32_t>(sources.size()));
+        if(source.second){
+            sources.emplace_back(found->second.first);
+        }
+
+        return std::make_pair(source.first->second, found->second.second);
+    }
+
+    SnapshotValue encode(const Data &value, const std::string &name){
+        SnapshotValue encoded = {};
+        if(const auto *pointer = std::get_if<void*>(&value)){
+            if(*pointer != nullptr){
+                std::pair<std::uint32_t, std::uint32_t> node = encodeNode(*pointer, NodeType::DEF_STM, name);
+                encoded.tag = SnapshotTag::FUNCTION;
+                encoded.index = node.first;
+                encoded.payload = node.second;
+            }
+        }else if(const auto *number = std::get_if<std::int32_t>(&value)){
+            encoded.tag = SnapshotTag::INT;
+            encoded.payload = static_cast<std::uint32_t>(*number);
+        }else if(const auto *number = std::get_if<float>(&value)){
+            encoded.tag = SnapshotTag::FLOAT;
+            std::memcpy(&encoded.index, number, sizeof(float));
+        }else if(const auto *str = std::get_if<std::string>(&value)){
+            encoded.tag = SnapshotTag::STRING;
+            encoded.index = static_cast<std::uint32_t>(str->size());
+            encoded.payload = append(str->data(), str->size());
+        }else if(const Ref &ref = std::get<Ref>(value)){
+            encoded.tag = SnapshotTag::OBJECT;
+            encoded.index = encodeObject(ref.get(), name);
+        }
+
+        return encoded;
+    }
+
+    std::uint32_t encodeObject(HeapObject *object, const std::string &name){
+        auto found = objectIndex.find(object);
+        if(found != objectIndex.end()){
+            return found->second;
+        }
+
+        if(object->kind != HeapObjectType::LIST && object->kind != HeapObjectType::UPVALUE && object->kind != HeapObjectType::CLOSURE){
+            throw ParserException("~Error~ \'" + name + "\' holds a canvas or sprite, a snapshot keeps numbers, strings, lists and functions.");
+        }
+
+        std::uint32_t index = static_cast<std::uint32_t>(objects.size());
+        objectIndex.emplace(object, index);
+        objects.emplace_back(SnapshotObject{static_cast<std::uint32_t>(object->kind), 0, 0, 0, 0});
+
+        SnapshotObject encoded = objects[index];
+        if(object->kind == HeapObjectType::LIST){
+            std::vector<SnapshotValue> items;
+            for(auto &e : static_cast<ListObject*>(object)->elements){
+                items.emplace_back(encode(e, name));
+            }
+            encoded.count = static_cast<std::uint32_t>(items.size());
+            encoded.itemsOffset = append(items.data(), items.size() * sizeof(SnapshotValue));
+        }else if(object->kind == HeapObjectType::UPVALUE){
+            SnapshotValue item = encode(*static_cast<UpvalueObject*>(object)->slot, name);
+            encoded.count = 1;
+            encoded.itemsOffset = append(&item, sizeof(item));
+        }else{
+            ClosureObject *closure = static_cast<ClosureObject*>(object);
+            std::pair<std::uint32_t, std::uint32_t> node = encodeNode(closure->node, NodeType::DEF_LAM_STM, name);
+            encoded.source = node.first;
+            encoded.node = node.second;
+
+            std::vector<SnapshotBinding> bindings;
+            for(auto &e : closure->upvalues){
+                std::uint32_t upvalue = encodeObject(e.second.get(), name);
+                bindings.emplace_back(SnapshotBinding{append(e.first.data(), e.first.size()), static_cast<std::uint32_t>(e.first.size()), upvalue});
+            }
+            encoded.count = static_cast<std::uint32_t>(bindings.size());
+            encoded.itemsOffset = append(bindings.data(), bindings.size() * sizeof(SnapshotBinding));
+        }
+        objects[index] = encoded;
+
+        return index;
+    }
+};
+
+std::size_t writeSnapshot(const std::string &path, ScopeManager &scope){
+    SnapshotBuilder builder(scope);
+
+    // Inner scopes shadow outer ones, like a lookup from here would.
+    std::map<std::string, Data> visible;
+    for(std::shared_ptr<SymbolTable> table = scope.getCurrentScope(); table != nullptr; table = table->getParent()){
+        for(auto &e : table->getData()){
+            visible.emplace(e.first, e.second);
+        }
+    }
+
+    std::vector<SnapshotVariable> variables;
+    for(auto &e : visible){
+        SnapshotValue value = builder.encode(e.second, e.first);
+        variables.emplace_back(SnapshotVariable{builder.append(e.first.data(), e.first.size()), static_cast<std::uint32_t>(e.first.size()), 0, value});
+    }
+
+    std::vector<SnapshotSource> sources;
+    for(std::size_t e : builder.sources){
+        const std::string &code = *scope.sources[e].code;
+        sources.emplace_back(SnapshotSource{builder.append(code.data(), code.size()), code.size()});
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.sourceCount = static_cast<std::uint32_t>(sources.size());
+    header.objectCount = static_cast<std::uint32_t>(builder.objects.size());
+    header.variableCount = static_cast<std::uint32_t>(variables.size());
+    header.dataOffset = alignTo8(sizeof(SnapshotHeader) + sources.size() * sizeof(SnapshotSource)
+        + builder.objects.size() * sizeof(SnapshotObject) + variables.size() * sizeof(SnapshotVariable));
+
+    FileWriter writer(path);
+    writer.write(&header, sizeof(header));
+    writer.write(sources.data(), sources.size() * sizeof(SnapshotSource));
+    writer.write(builder.objects.data(), builder.objects.size() * sizeof(SnapshotObject));
+    writer.write(variables.data(), variables.size() * sizeof(SnapshotVariable));
+    static const std::uint8_t padding[8] = {0};
+    writer.write(padding, header.dataOffset - writer.written());
+    writer.write(builder.data.data(), builder.data.size());
+    writer.close();
+
+    return variables.size();
+}
+
+/* Loading */
+struct SnapshotMapping{
+    // Variables
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+
+    // Constructor & Destructor
+    SnapshotMapping() = default;
+    ~SnapshotMapping(){
+        if(data != nullptr){
+            munmap(const_cast<std::uint8_t*>(data), size);
+        }
+    }
+
+    SnapshotMapping(const SnapshotMapping&) = delete;
+    SnapshotMapping &operator=(const SnapshotMapping&) = delete;
+};
+
+// Every offset and index is checked before it is used, a damaged file only fails to load.
+struct SnapshotReader{
+    // Variables
+    const std::string &path;
+    const std::uint8_t *data;
+    std::size_t size;
+    std::vector<std::vector<AbstractNode*>> nodes;
+    std::vector<Ref> objects;
+
+    // Functions
+    [[noreturn]] void fail() const{
+        throw ParserException("~Error~ Invalid snapshot \'" + path + "\'.");
+    }
+
+    template<typename T> const T *items(std::uint64_t offset, std::uint64_t count) const{
+        if(offset % alignof(T) != 0 || offset > size || count > (size - offset) / sizeof(T)){
+            fail();
+        }
+
+        return reinterpret_cast<const T*>(data + offset);
+    }
+
+    std::string text(std::uint64_t offset, std::uint64_t length) const{
+        return std::string(items<char>(offset, length), length);
+    }
+
+    // Calls trust the node kind, so it has to be the one the value needs.
+    AbstractNode *node(std::uint32_t source, std::uint64_t index, NodeType type) const{
+        if(source >= nodes.size() || index >= nodes[source].size() || nodes[source][index]->info.type != type){
+            fail();
+        }
+
+        return nodes[source][index];
+    }
+
+    // Objects decode to an empty placeholder until every object exists.
+    Data decode(const SnapshotValue &value, bool isLinked) const{
+        switch(value.tag){
+        case SnapshotTag::NONE:
+            return Data();
+        case SnapshotTag::INT:
+            return static_cast<std::int32_t>(static_cast<std::uint32_t>(value.payload));
+        case SnapshotTag::FLOAT:
+            {
+                float number;
+                std::memcpy(&number, &value.index, sizeof(float));
+                return number;
+            }
+        case SnapshotTag::STRING:
+            return text(value.payload, value.index);
+        case SnapshotTag::OBJECT:
+            if(value.index >= objects.size()){
+                fail();
+            }
+            return isLinked ? Data(objects[value.index]) : Data();
+        case SnapshotTag::FUNCTION:
+            return Data(static_cast<void*>(node(value.index, value.payload, NodeType::DEF_STM)));
+        default:
+            fail();
+        }
+    }
+};
+
+std::size_t loadSnapshot(const std::string &path, ScopeManager &scope){
+    TraceSpan span("load snapshot " + path, "interpreter");
+    SnapshotMapping mapping;
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0){
+        throw ParserException("~Error~ Could not open snapshot \'" + path + "\'.");
+    }
+
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if(fstat(descriptor, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(SnapshotHeader))){
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    ::close(descriptor);
+    if(mapped == MAP_FAILED){
+        throw ParserException("~Error~ Could not map snapshot \'" + path + "\'.");
+    }
+    mapping.data = static_cast<const std::uint8_t*>(mapped);
+    mapping.size = info.st_size;
+
+    const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader*>(mapping.data);
+    std::uint64_t tableBytes = sizeof(SnapshotHeader) + static_cast<std::uint64_t>(header->sourceCount) * sizeof(SnapshotSource)
+        + static_cast<std::uint64_t>(header->objectCount) * sizeof(SnapshotObject) + static_cast<std::uint64_t>(header->variableCount) * sizeof(SnapshotVariable);
+    if(std::memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0 || header->version != SNAPSHOT_VERSION
+        || header->dataOffset < tableBytes || header->dataOffset > mapping.size || header->dataOffset % 8 != 0){
+        throw ParserException("~Error~ Invalid snapshot \'" + path + "\'.");
+    }
+
+    const SnapshotSource *sources = reinterpret_cast<const SnapshotSource*>(mapping.data + sizeof(SnapshotHeader));
+    const SnapshotObject *objects = reinterpret_cast<const SnapshotObject*>(sources + header->sourceCount);
+    const SnapshotVariable *variables = reinterpret_cast<const SnapshotVariable*>(objects + header->objectCount);
+    SnapshotReader reader{path, mapping.data + header->dataOffset, mapping.size - header->dataOffset, {}, {}};
+
+    // The functions need their trees, parsed again from the saved code and kept by the scope.
+    Interpreter interpreter;
+    for(std::uint32_t i = 0; i < header->sourceCount; ++i){
+        std::shared_ptr<const std::string> code = std::make_shared<const std::string>(reader.text(sources[i].codeOffset, sources[i].codeLength));
+        std::vector<Token> tokens = interpreter.lex(*code, DEFAULT_REGEX_PATTERN);
+        TreeParser parser;
+        std::shared_ptr<AbstractNode> root = parser.parse(tokens);
+        if(root == nullptr){
+            reader.fail();
+        }
+
+        reader.nodes.emplace_back();
+        collectNodes(root.get(), reader.nodes.back());
+        scope.sources.emplace_back(LoadedSource{code, root});
+    }
+
+    // Objects are made first and linked afterwards, so they may point at each other in any order.
+    Heap &heap = scope.getHeap();
+    std::shared_ptr<SymbolTable> globalScope = scope.getGlobalScope();
+    reader.objects.resize(header->objectCount);
+    for(std::uint32_t i = 0; i < header->objectCount; ++i){
+        const SnapshotObject &object = objects[i];
+        switch(static_cast<HeapObjectType>(object.kind)){
+        case HeapObjectType::LIST:
+            {
+                const SnapshotValue *items = reader.items<SnapshotValue>(object.itemsOffset, object.count);
+                std::vector<Data> elements;
+                elements.reserve(object.count);
+                for(std::uint32_t j = 0; j < object.count; ++j){
+                    elements.emplace_back(reader.decode(items[j], false));
+                }
+                reader.objects[i] = heap.make<ListObject>(std::move(elements));
+            }
+            break;
+        case HeapObjectType::UPVALUE:
+            {
+                reader.objects[i] = heap.make<UpvalueObject>(nullptr);
+                UpvalueObject *upvalue = reader.objects[i].as<UpvalueObject>();
+                upvalue->slot = &upvalue->closed;
+            }
+            break;
+        case HeapObjectType::CLOSURE:
+            {
+                const SnapshotBinding *bindings = reader.items<SnapshotBinding>(object.itemsOffset, object.count);
+                std::vector<std::pair<std::string, Ref>> upvalues;
+                for(std::uint32_t j = 0; j < object.count; ++j){
+                    upvalues.emplace_back(reader.text(bindings[j].nameOffset, bindings[j].nameLength), Ref());
+                }
+                reader.objects[i] = heap.make<ClosureObject>(reader.node(object.source, object.node, NodeType::DEF_LAM_STM), std::move(upvalues), globalScope);
+            }
+            break;
+        default:
+            reader.fail();
+        }
+    }
+
+    for(std::uint32_t i = 0; i < header->objectCount; ++i){
+        const SnapshotObject &object = objects[i];
+        if(object.kind == static_cast<std::uint32_t>(HeapObjectType::LIST)){
+            const SnapshotValue *items = reader.items<SnapshotValue>(object.itemsOffset, object.count);
+            std::vector<Data> &elements = reader.objects[i].as<ListObject>()->elements;
+            for(std::uint32_t j = 0; j < object.count; ++j){
+                if(items[j].tag == SnapshotTag::OBJECT){
+                    elements[j] = reader.decode(items[j], true);
+                }
+            }
+        }else if(object.kind == static_cast<std::uint32_t>(HeapObjectType::UPVALUE)){
+            if(object.count != 1){
+                reader.fail();
+            }
+            reader.objects[i].as<UpvalueObject>()->closed = reader.decode(*reader.items<SnapshotValue>(object.itemsOffset, 1), true);
+        }else{
+            const SnapshotBinding *bindings = reader.items<SnapshotBinding>(object.itemsOffset, object.count);
+            ClosureObject *closure = reader.objects[i].as<ClosureObject>();
+            for(std::uint32_t j = 0; j < object.count; ++j){
+                if(bindings[j].upvalue >= reader.objects.size() || reader.objects[bindings[j].upvalue].get()->kind != HeapObjectType::UPVALUE){
+                    reader.fail();
+                }
+                closure->upvalues[j].second = reader.objects[bindings[j].upvalue];
+            }
+        }
+    }
+
+    for(std::uint32_t i = 0; i < header->variableCount; ++i){
+        globalScope->push(reader.text(variables[i].nameOffset, variables[i].nameLength), reader.decode(variables[i].value, true));
+    }
+
+    return header->variableCount;
+}
@@ -1,21 +1,137 @@
 #include "headers/CommonLibs.hpp"
 #include "headers/Interpreter.hpp"
+#include "headers/Server.hpp"
 
 const std::string versionInformation = R"(Canvas Alpha v0.1)";
 const std::string helpInformation = 
 R"(Usage: canvas [options] [-e <filename>]
                 
 options:
-    -h | --help    : Display help
-    -v | --version : Display version
-    -e | --execute : Execute file)";
+    -h | --help             : Display help
+    -v | --version          : Display version
+    -e | --execute          : Execute file
+    --repl                  : Read and run statements interactively, keeping variables between them
+    --serve <socket>        : Run scripts sent to a unix socket, keeping parsed programs warm
+    --connect <socket>      : Make -e send the file to a --serve daemon and print its output
+    --max-heap <bytes>      : Limit the script heap size (0 = unlimited)
+    --max-depth <calls>     : Limit the call depth (default 10000), the native stack grows with it
+    --max-steps <steps>     : Stop the script after this many loop iterations and calls (0 = unlimited)
+    --timeout <ms>          : Stop the script after this many milliseconds (0 = unlimited)
+    --assets <cache>        : Map a pre-decoded asset cache written by cache_assets()
+    --from-snapshot <file>  : Start with the variables and functions saved by snapshot(<file>)
+    --frames <pattern|->    : Write every frame_end() as numbered images ("out/f_%04d.png"), a .y4m
+                              file, or a Y4M stream on stdout ("-", other output moves to stderr)
+    --fps <rate>            : Frame rate written in Y4M headers (default 30)
+    --profile <file>        : Sample the script, write collapsed stacks for flamegraphs to <file> and
+                              print the hottest functions and lines
+    --profile-mode <mode>   : "sample" (default) or "instrument", which also times every call
+    --profile-interval <us> : Time between two samples (default 1000)
+    --trace <file>          : Write a Chrome/Perfetto trace of loading, lexing, parsing, execution,
+                              imports, function calls and trace_begin() regions to <file>
+    --mem-report            : Print the current and peak bytes allocated for tokens, the AST, scopes,
+                              values, heap objects and pixels when the script ends
+    --stats                 : Print how often each node kind, scope lookup and builtin ran (needs a
+                              build configured with -DCANVAS_STATS=ON))";
 
-int executeFile(const std::string fileName){
-    Interpreter mainInterpreter;
-    ScopeManager mainScopeManager;
+struct ExecutionOptions{
+    ExecutionLimits limits;
+    std::string frames;
+    int fps = 30;
+    std::string profile;
+    ProfileMode profileMode = ProfileMode::SAMPLE;
+    int profileInterval = DEFAULT_PROFILE_INTERVAL_US;
+    bool stats = false;
+    std::string trace;
+    bool memReport = false;
+    std::string connect;
+    std::string snapshot;
+};
+
+int executeFile(const std::string fileName, const ExecutionOptions &options){
+    if(!options.connect.empty()){
+        return runClient(options.connect, fileName);
+    }
+
+    RET_CODE exitCode = RET_CODE::NONE;
+    if(!options.trace.empty()){
+        tracer().open(options.trace);
+    }
+    if(!options.frames.empty()){
+        try{
+            frameSink().open(options.frames, options.fps);
+        }catch(const Error &e){
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    try{
+        runWithStackSize(nativeStackSizeFor(options.limits.maxCallDepth), [&](){
+            Interpreter mainInterpreter;
+            ScopeManager mainScopeManager;
+            mainScopeManager.applyLimits(options.limits);
+
+            std::unique_ptr<Profiler> profiler;
+            if(!options.profile.empty()){
+                profiler = std::make_unique<Profiler>(options.profileMode, options.limits.maxCallDepth, options.profileInterval);
+                mainScopeManager.profiler = profiler.get();
+                profiler->start();
+            }
+
+            tracer().nameThread("main");
+            if(!options.snapshot.empty()){
+                try{
+                    loadSnapshot(options.snapshot, mainScopeManager);
+                }catch(const Error &e){
+                    std::cout << e.what() << std::endl;
+                    exitCode = RET_CODE::ERR;
+                    return;
+                }
+            }
+
+            std::string code;
+            {
+                TraceSpan span("load " + fileName, "interpreter");
+                code = loadFileContentAsCode(fileName);
+            }
+            exitCode = mainInterpreter.execute(code, mainScopeManager, DebugType::DETAILED);
+            if(options.memReport){
+                writeMemoryReport(std::cout);
+            }
+
+            if(profiler != nullptr){
+                profiler->stop();
+                mainScopeManager.profiler = nullptr;
+                std::ofstream file(options.profile);
+                profiler->writeCollapsed(file);
+                if(!file){
+                    std::cout << "~Error~ Could not write \'" << options.profile << "\'." << std::endl;
+                }
+                profiler->writeReport(std::cout);
+            }
+        });
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        exitCode = RET_CODE::ERR;
+    }
+
+    try{
+        frameSink().close();
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        exitCode = RET_CODE::ERR;
+    }
+
+    try{
+        tracer().close();
+    }catch(const Error &e){
+        std::cout << e.what() << std::endl;
+        exitCode = RET_CODE::ERR;
+    }
     
-    std::string code = loadFileContentAsCode(fileName); 
-    RET_CODE exitCode = mainInterpreter.execute(code, mainScopeManager, DebugType::DETAILED);
+    if(options.stats){
+        writeStats(std::cout);
+    }
     
     if(exitCode == RET_CODE::ERR){
         std::cout << "Exited with errors." << std::endl;
@@ -30,6 +146,7 @@ int main(int argc, char** argv){
         
         return 1;
     }else{
+        ExecutionOptions options;
         for(std::uint8_t argIndex = 1; argIndex < argc; argIndex++){
             const std::string argStr = argv[argIndex];
             
@@ -44,7 +161,123 @@ int main(int argc, char** argv){
                     std::cout << "~Error~ Missing '<filename>' \n~Try~ -e <filename>" << std::endl;
                     return 1;
                 }else{
-                    return executeFile(argv[argIndex + 1]);
+                    return executeFile(argv[argIndex + 1], options);
+                }
+            }else if(argStr == "--repl"){
+                return runRepl(options.limits);
+            }else if(argStr == "--serve"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<socket>' \n~Try~ --serve /tmp/canvas.sock" << std::endl;
+                    return 1;
+                }else{
+                    return runServer(argv[argIndex + 1], options.limits);
+                }
+            }else if(argStr == "--connect"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<socket>' \n~Try~ --connect /tmp/canvas.sock -e <filename>" << std::endl;
+                    return 1;
+                }else{
+                    options.connect = argv[++argIndex];
+                }
+            }else if(argStr == "--max-heap"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<bytes>' \n~Try~ --max-heap <bytes>" << std::endl;
+                    return 1;
+                }else{
+                    options.limits.maxHeap = std::stoull(argv[++argIndex]);
+                }
+            }else if(argStr == "--max-depth"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<calls>' \n~Try~ --max-depth <calls>" << std::endl;
+                    return 1;
+                }else{
+                    options.limits.maxCallDepth = std::stoull(argv[++argIndex]);
+                }
+            }else if(argStr == "--max-steps"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<steps>' \n~Try~ --max-steps <steps>" << std::endl;
+                    return 1;
+                }else{
+                    options.limits.maxSteps = std::stoull(argv[++argIndex]);
+                }
+            }else if(argStr == "--timeout"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<ms>' \n~Try~ --timeout <ms>" << std::endl;
+                    return 1;
+                }else{
+                    options.limits.timeout = std::chrono::milliseconds(std::stoull(argv[++argIndex]));
+                }
+            }else if(argStr == "--frames"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<pattern>' \n~Try~ --frames out/frame_%04d.png" << std::endl;
+                    return 1;
+                }else{
+                    options.frames = argv[++argIndex];
+                }
+            }else if(argStr == "--fps"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<rate>' \n~Try~ --fps <rate>" << std::endl;
+                    return 1;
+                }else{
+                    options.fps = std::stoi(argv[++argIndex]);
+                }
+            }else if(argStr == "--profile"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<file>' \n~Try~ --profile out.folded" << std::endl;
+                    return 1;
+                }else{
+                    options.profile = argv[++argIndex];
+                }
+            }else if(argStr == "--profile-mode"){
+                std::string mode = argIndex == argc - 1 ? "" : argv[++argIndex];
+                if(mode == "sample"){
+                    options.profileMode = ProfileMode::SAMPLE;
+                }else if(mode == "instrument"){
+                    options.profileMode = ProfileMode::INSTRUMENT;
+                }else{
+                    std::cout << "~Error~ Missing '<mode>' \n~Try~ --profile-mode sample|instrument" << std::endl;
+                    return 1;
+                }
+            }else if(argStr == "--profile-interval"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<us>' \n~Try~ --profile-interval <us>" << std::endl;
+                    return 1;
+                }else{
+                    options.profileInterval = std::stoi(argv[++argIndex]);
+                }
+            }else if(argStr == "--trace"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<file>' \n~Try~ --trace out.json" << std::endl;
+                    return 1;
+                }else{
+                    options.trace = argv[++argIndex];
+                }
+            }else if(argStr == "--mem-report"){
+                options.memReport = true;
+            }else if(argStr == "--stats"){
+                if(!isStatsEnabled()){
+                    std::cout << "~Error~ This build counts no statistics. \n~Try~ cmake -DCANVAS_STATS=ON" << std::endl;
+                    return 1;
+                }
+                options.stats = true;
+            }else if(argStr == "--from-snapshot"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<file>' \n~Try~ --from-snapshot <file>" << std::endl;
+                    return 1;
+                }else{
+                    options.snapshot = argv[++argIndex];
+                }
+            }else if(argStr == "--assets"){
+                if(argIndex == argc - 1){
+                    std::cout << "~Error~ Missing '<cache>' \n~Try~ --assets <cache>" << std::endl;
+                    return 1;
+                }else{
+                    try{
+                        assetCache().open(argv[++argIndex]);
+                    }catch(const Error &e){
+                        std::cout << e.what() << std::endl;
+                        return 1;
+                    }
                 }
             }else{
                 std::cout << "~Error~ Invalid argument \'" << argStr << '\'' << std::endl;
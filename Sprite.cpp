@@ -0,0 +1,62 @@
+#include "headers/Sprite.hpp"
+#include "headers/Error.hpp"
+#include <cmath>
+#include <numeric>
+
+/* SpriteObject Struct */
+// Constructor & Destructor
+SpriteObject::SpriteObject(Ref image, const ClipRect &region) : HeapObject(HeapObjectType::SPRITE), image(std::move(image)), region(region){}
+
+// Functions
+std::size_t SpriteObject::byteSize() const{
+    return sizeof(SpriteObject);
+}
+
+std::vector<AtlasPlacement> packAtlas(const std::vector<std::pair<int, int>> &sizes, int &atlasWidth, int &atlasHeight){
+    std::vector<AtlasPlacement> placements(sizes.size());
+    std::vector<std::size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](std::size_t a, std::size_t b){ return sizes[a].second > sizes[b].second; });
+
+    std::uint64_t area = 0;
+    int widest = 1;
+    for(const auto &e : sizes){
+        area += static_cast<std::uint64_t>(e.first) * e.second;
+        widest = std::max(widest, e.first);
+    }
+
+    // Rows of the atlas are padded to 16 pixels anyway, so the width is rounded up to match.
+    atlasWidth = std::max(widest, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area)))));
+    atlasWidth = std::min(65535, (atlasWidth + 15) & ~15);
+
+    int x = 0, y = 0, shelfHeight = 0;
+    for(std::size_t index : order){
+        if(x + sizes[index].first > atlasWidth){
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        placements[index] = AtlasPlacement{x, y};
+        x += sizes[index].first;
+        shelfHeight = std::max(shelfHeight, sizes[index].second);
+    }
+
+    atlasHeight = std::max(1, y + shelfHeight);
+    if(atlasHeight > 65535){
+        throw ParserException("~Error~ Sprites do not fit in a 65535x65535 atlas.");
+    }
+
+    return placements;
+}
+
+// Helper Functions
+SpriteObject *asSprite(const Data &data, const std::string &identifier){
+    if(const auto *refPtr = std::get_if<Ref>(&data)){
+        if(*refPtr && refPtr->get()->kind == HeapObjectType::SPRITE){
+            return refPtr->as<SpriteObject>();
+        }
+    }
+
+    throw ParserException("~Error~ \'" + identifier + "\' expects a sprite.");
+}
@@ -0,0 +1,113 @@
+#include "headers/Stats.hpp"
+#include "headers/AST.hpp"
+#include <iomanip>
+#include <mutex>
+
+// Counters of every thread that evaluated code, kept after the thread exits.
+static std::mutex statsMutex;
+static std::vector<std::unique_ptr<EvalStats>> statsRegistry;
+
+#ifdef CANVAS_STATS
+EvalStats &threadStats(){
+    thread_local EvalStats *stats = [](){
+        std::lock_guard<std::mutex> lock(statsMutex);
+        statsRegistry.emplace_back(std::make_unique<EvalStats>());
+        return statsRegistry.back().get();
+    }();
+
+    return *stats;
+}
+#endif
+
+// Helper Functions
+bool isStatsEnabled(){
+#ifdef CANVAS_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Sums the counters of all threads, call it once the isolates finished.
+EvalStats collectStats(){
+    EvalStats total;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for(auto &e : statsRegistry){
+        for(std::size_t i = 0; i < STATS_NODE_KINDS; ++i){
+            total.nodes[i] += e->nodes[i];
+        }
+        total.pushScope += e->pushScope;
+        total.findData += e->findData;
+        total.scopeHops += e->scopeHops;
+        total.stringCopies += e->stringCopies;
+        total.userCalls += e->userCalls;
+        for(auto &builtin : e->builtins){
+            total.builtins[builtin.first] += builtin.second;
+        }
+    }
+
+    return total;
+}
+
+void writeStats(std::ostream &stream){
+    static const std::map<NodeType, std::string> nodeNames = {
+        {NodeType::BLC_STM, "block"},
+        {NodeType::ABS_LST, "list"},
+        {NodeType::BIN_EXP, "binary"},
+        {NodeType::UNR_EXP, "unary"},
+        {NodeType::IFC_STM, "if"},
+        {NodeType::WHL_STM, "while"},
+        {NodeType::FOR_STM, "for/foreach"},
+        {NodeType::REP_STM, "repeat"},
+        {NodeType::DEF_STM, "def"},
+        {NodeType::DEF_LAM_STM, "lambda"},
+        {NodeType::RET_STM, "ret"},
+        {NodeType::BRK_STM, "break"},
+        {NodeType::CON_STM, "continue"},
+        {NodeType::CAL_STM, "call"},
+        {NodeType::ASG_STM, "assignment"},
+        {NodeType::IDN, "identifier"},
+        {NodeType::NUM_LIT, "number"},
+        {NodeType::STR_LIT, "string"}
+    };
+
+    EvalStats stats = collectStats();
+    auto writeSorted = [&](const std::vector<std::pair<std::string, std::uint64_t>> &counts){
+        std::vector<std::pair<std::string, std::uint64_t>> sorted(counts);
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b){
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        for(auto &e : sorted){
+            stream << "  " << std::left << std::setw(20) << e.first << std::right << std::setw(14) << e.second << '\n';
+        }
+    };
+
+    std::vector<std::pair<std::string, std::uint64_t>> nodes;
+    std::uint64_t totalNodes = 0;
+    for(std::size_t i = 0; i < STATS_NODE_KINDS; ++i){
+        if(stats.nodes[i] != 0){
+            auto name = nodeNames.find(static_cast<NodeType>(i));
+            nodes.emplace_back(name != nodeNames.end() ? name->second : "#" + std::to_string(i), stats.nodes[i]);
+            totalNodes += stats.nodes[i];
+        }
+    }
+
+    stream << "\nEvaluated nodes (" << totalNodes << ")\n";
+    writeSorted(nodes);
+
+    stream << "Scopes and data\n";
+    writeSorted({
+        {"pushScope", stats.pushScope},
+        {"findData", stats.findData},
+        {"scope hops", stats.scopeHops},
+        {"string copies", stats.stringCopies},
+        {"user calls", stats.userCalls}
+    });
+    if(stats.findData != 0){
+        stream << "  " << std::fixed << std::setprecision(2) << static_cast<double>(stats.scopeHops) / stats.findData << " hops per lookup\n" << std::defaultfloat;
+    }
+
+    stream << "Builtin calls\n";
+    writeSorted(std::vector<std::pair<std::string, std::uint64_t>>(stats.builtins.begin(), stats.builtins.end()));
+    stream << std::flush;
+}
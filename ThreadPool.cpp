@@ -0,0 +1,137 @@
+#include "headers/ThreadPool.hpp"
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstdlib>
+
+struct ThreadPool::Job{
+    // Variables
+    const std::function<void(std::size_t)> *task;
+    std::size_t count;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr exception;
+};
+
+/* ThreadPool Class */
+// Constructor & Destructor
+ThreadPool::ThreadPool(std::size_t threadCount){
+    m_workers.reserve(threadCount);
+    for(std::size_t i = 0; i < threadCount; ++i){
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_condition.notify_all();
+
+    for(auto &e : m_workers){
+        e.join();
+    }
+}
+
+// Functions
+std::size_t ThreadPool::size() const{
+    return m_workers.size();
+}
+
+void ThreadPool::work(){
+    while(true){
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return !m_jobs.empty() || m_isStopping; });
+            if(m_jobs.empty()){
+                return;
+            }
+
+            job = m_jobs.front();
+            // The job leaves the queue once every index has been handed out.
+            if(job->next.load() >= job->count){
+                m_jobs.pop_front();
+                continue;
+            }
+        }
+
+        runJob(*job);
+    }
+}
+
+// Claims indices until none are left, the last finished index wakes the caller.
+void ThreadPool::runJob(Job &job){
+    std::size_t index;
+    while((index = job.next.fetch_add(1)) < job.count){
+        try{
+            (*job.task)(index);
+        }catch(...){
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if(!job.exception){
+                job.exception = std::current_exception();
+            }
+        }
+
+        if(job.done.fetch_add(1) + 1 == job.count){
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &task){
+    if(count == 0){
+        return;
+    }
+
+    if(count == 1 || m_workers.empty()){
+        for(std::size_t i = 0; i < count; ++i){
+            task(i);
+        }
+        return;
+    }
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->task = &task;
+    job->count = count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.emplace_back(job);
+    }
+    m_condition.notify_all();
+
+    runJob(*job);
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&job]{ return job->done.load() == job->count; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto position = std::find(m_jobs.begin(), m_jobs.end(), job);
+        if(position != m_jobs.end()){
+            m_jobs.erase(position);
+        }
+    }
+
+    if(job->exception){
+        std::rethrow_exception(job->exception);
+    }
+}
+
+// Helper Functions
+// Sized to the hardware threads, or to CANVAS_THREADS when set; the calling thread counts as one.
+ThreadPool &sharedThreadPool(){
+    static ThreadPool pool([](){
+        std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if(const char *variable = std::getenv("CANVAS_THREADS")){
+            threadCount = std::max(1, std::atoi(variable));
+        }
+
+        return threadCount - 1;
+    }());
+    return pool;
+}
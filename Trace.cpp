@@ -0,0 +1,157 @@
+#include "headers/Trace.hpp"
+#include "headers/Error.hpp"
+#include <cstdio>
+#include <fstream>
+
+// Names are script strings, so quotes, backslashes and control characters are escaped.
+static std::string escapeTraceName(const std::string &text){
+    std::string escaped;
+    escaped.reserve(text.size());
+    for(char e : text){
+        if(e == '"' || e == '\\'){
+            escaped += '\\';
+            escaped += e;
+        }else if(static_cast<unsigned char>(e) < 0x20){
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", e);
+            escaped += code;
+        }else{
+            escaped += e;
+        }
+    }
+
+    return escaped;
+}
+
+/* Tracer Class */
+// Functions
+void Tracer::open(const std::string &path){
+    m_path = path;
+    m_startTime = std::chrono::steady_clock::now();
+    m_isEnabled.store(true, std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer &Tracer::buffer(){
+    thread_local ThreadBuffer *threadBuffer = nullptr;
+    if(threadBuffer == nullptr){
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        threadBuffer = m_buffers.back().get();
+        threadBuffer->tid = static_cast<int>(m_buffers.size());
+        threadBuffer->name = "thread " + std::to_string(threadBuffer->tid);
+    }
+
+    return *threadBuffer;
+}
+
+double Tracer::now() const{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void Tracer::endSpan(ThreadBuffer &buffer, std::vector<Span> &spans, double end){
+    Span &span = spans.back();
+    buffer.events.emplace_back(Event{std::move(span.name), span.category, span.start, end - span.start});
+    spans.pop_back();
+}
+
+void Tracer::nameThread(const std::string &name){
+    if(isEnabled()){
+        buffer().name = name;
+    }
+}
+
+void Tracer::begin(const std::string &name, const char *category){
+    buffer().spans.emplace_back(Span{name, category, now()});
+}
+
+void Tracer::end(){
+    ThreadBuffer &threadBuffer = buffer();
+    if(!threadBuffer.spans.empty()){
+        endSpan(threadBuffer, threadBuffer.spans, now());
+    }
+}
+
+// Script regions have their own stack, so a region may outlive the call that began it.
+void Tracer::beginScript(const std::string &name){
+    buffer().scriptSpans.emplace_back(Span{name, "script", now()});
+}
+
+bool Tracer::endScript(){
+    ThreadBuffer &threadBuffer = buffer();
+    if(threadBuffer.scriptSpans.empty()){
+        return false;
+    }
+
+    endSpan(threadBuffer, threadBuffer.scriptSpans, now());
+    return true;
+}
+
+// Ends the regions a script of this thread left open, for hosts running one script after another.
+void Tracer::endScripts(){
+    if(!isEnabled()){
+        return;
+    }
+
+    ThreadBuffer &threadBuffer = buffer();
+    double end = now();
+    while(!threadBuffer.scriptSpans.empty()){
+        endSpan(threadBuffer, threadBuffer.scriptSpans, end);
+    }
+}
+
+// Writes the trace, call it once every traced thread finished.
+void Tracer::close(){
+    if(!m_isEnabled.exchange(false)){
+        return;
+    }
+
+    double end = now();
+    std::ofstream file(m_path);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file.precision(3);
+    file << std::fixed;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool isFirst = true;
+    for(auto &e : m_buffers){
+        while(!e->spans.empty()){
+            endSpan(*e, e->spans, end);
+        }
+        while(!e->scriptSpans.empty()){
+            endSpan(*e, e->scriptSpans, end);
+        }
+
+        file << (isFirst ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << e->tid
+            << ", \"args\": {\"name\": \"" << escapeTraceName(e->name) << "\"}}";
+        isFirst = false;
+        for(auto &event : e->events){
+            file << ",\n{\"name\": \"" << escapeTraceName(event.name) << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e->tid
+                << ", \"ts\": " << event.start << ", \"dur\": " << event.duration << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    if(!file){
+        throw ParserException("~Error~ Could not write the trace \'" + m_path + "\'.");
+    }
+}
+
+/* TraceSpan Class */
+// Constructor & Destructor
+TraceSpan::TraceSpan(const std::string &name, const char *category) : m_isActive(tracer().isEnabled()){
+    if(m_isActive){
+        tracer().begin(name, category);
+    }
+}
+
+TraceSpan::~TraceSpan(){
+    if(m_isActive){
+        tracer().end();
+    }
+}
+
+// Helper Functions
+Tracer &tracer(){
+    static Tracer instance;
+    return instance;
+}
@@ -1,4 +1,6 @@
 #include "headers/Utility.hpp"
+#include "headers/Error.hpp"
+#include <pthread.h>
 
 // Grammar Utility
 bool g_util::isKeyword(std::string &str){
@@ -100,6 +102,8 @@ float variantAsNum(Data &data){
         return *intPtr;
     }else if(const auto* voidPtr = std::get_if<void*>(&data)){
         return reinterpret_cast<long>(voidPtr);
+    }else if(const auto* refPtr = std::get_if<Ref>(&data)){
+        return reinterpret_cast<long>(refPtr->get());
     }
     
     return std::get<float>(data);
@@ -112,6 +116,8 @@ std::string variantAsStr(Data &data) {
         return std::to_string(*floatPtr);
     }else if(const auto* voidPtr = std::get_if<void*>(&data)){
         return "(_PTR)" + std::to_string(reinterpret_cast<long>(voidPtr));
+    }else if(const auto* refPtr = std::get_if<Ref>(&data)){
+        return "(_OBJ)" + std::to_string(reinterpret_cast<long>(refPtr->get()));
     }
 
     return std::get<std::string>(data);
@@ -124,6 +130,8 @@ bool isVariantEmptyOrNull(Data data){
         return *floatPtr == 0;
     }else if(const auto *strPtr = std::get_if<std::string>(&data)){
         return strPtr->empty() || *strPtr == "\"\"";
+    }else if(const auto *refPtr = std::get_if<Ref>(&data)){
+        return !*refPtr;
     }
     
     return true;
@@ -149,14 +157,66 @@ std::string loadFileContentAsCode(std::string fileName){
         return "";
     }
 
+    return loadSourceAsCode(file);
+}
+
+// Wraps the source in one block. Skipped lines stay as empty ones so token rows are the line
+// numbers of the source.
+std::string loadSourceAsCode(std::istream &stream){
     std::string readLine;
     std::string content = "{\n";
-    while(std::getline(file, readLine)){
+    while(std::getline(stream, readLine)){
         if (!readLine.empty() && readLine != "\n" && readLine[0] != '#') {
             content.append(readLine + "\n");
+        }else{
+            content.append("\n");
         }
-    } file.close();
+    }
     content.append("}");
 
     return content;
-}
\ No newline at end of file
+}
+
+// Runs the task on a new thread with the given native stack size and waits for it, exceptions
+// escaping the task are rethrown on the calling thread. A stack that cannot be reserved is an
+// error, running on a smaller one would let deep recursion crash instead of stopping at the depth.
+void runWithStackSize(std::size_t stackBytes, const std::function<void()> &task){
+    struct ThreadTask{
+        const std::function<void()> *task;
+        std::exception_ptr exception;
+    } threadTask = {&task, nullptr};
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, std::max<std::size_t>(stackBytes, PTHREAD_STACK_MIN));
+
+    pthread_t thread;
+    int result = pthread_create(&thread, &attributes, [](void *argument) -> void*{
+        ThreadTask *threadTask = static_cast<ThreadTask*>(argument);
+        try{
+            (*threadTask->task)();
+        }catch(...){
+            threadTask->exception = std::current_exception();
+        }
+
+        return nullptr;
+    }, &threadTask);
+    pthread_attr_destroy(&attributes);
+
+    if(result != 0){
+        throw Error("~Error~ Could not reserve a native stack of " + std::to_string(stackBytes / (1024 * 1024)) + "MB for the call depth, lower --max-depth.");
+    }
+
+    pthread_join(thread, nullptr);
+    if(threadTask.exception){
+        std::rethrow_exception(threadTask.exception);
+    }
+}
+
+std::size_t nativeStackSizeFor(std::size_t maxCallDepth){
+    if(maxCallDepth > SIZE_MAX / NATIVE_STACK_PER_CALL - 512){
+        return SIZE_MAX;
+    }
+
+    return (maxCallDepth + 512) * NATIVE_STACK_PER_CALL;
+}
@@ -0,0 +1,279 @@
+#include "headers/Video.hpp"
+#include "headers/ThreadPool.hpp"
+#include "headers/Error.hpp"
+#include <cstring>
+#include <cctype>
+#include <iostream>
+#include <unistd.h>
+
+/* FrameSink Class */
+// Constructor & Destructor
+FrameSink::~FrameSink(){
+    try{
+        close();
+    }catch(const Error &e){
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+// Functions
+void FrameSink::open(const std::string &target, int fps){
+    close();
+    if(fps <= 0){
+        throw ParserException("~Error~ Invalid frame rate " + std::to_string(fps) + ".");
+    }
+
+    std::size_t dot = target.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : target.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char e){ return std::tolower(e); });
+    m_isY4m = target == "-" || extension == "y4m";
+
+    if(m_isY4m && target == "-"){
+        // Text output moves to stderr so the stream on stdout stays clean.
+        std::cout.flush();
+        std::fflush(stdout);
+        int fd = dup(STDOUT_FILENO);
+        std::FILE *file = fd < 0 ? nullptr : fdopen(fd, "wb");
+        if(!file || dup2(STDERR_FILENO, STDOUT_FILENO) < 0){
+            throw ParserException("~Error~ Could not redirect stdout for the frame stream.");
+        }
+        m_stream = std::make_unique<FileWriter>(file, "stdout");
+    }else if(m_isY4m){
+        m_stream = std::make_unique<FileWriter>(target);
+    }else{
+        std::size_t percent = target.find('%');
+        std::size_t end = percent == std::string::npos ? percent : percent + 1;
+        while(end < target.size() && std::isdigit(static_cast<unsigned char>(target[end]))){
+            ++end;
+        }
+        if(percent == std::string::npos || end >= target.size() || target[end] != 'd' || end - percent > 3 || target.find('%', end) != std::string::npos){
+            throw ParserException("~Error~ Frame pattern \'" + target + "\' needs one %d or %0Nd, or a .y4m path.");
+        }
+
+        m_format = parseImageFormat(target, "");
+        m_prefix = target.substr(0, percent);
+        m_suffix = target.substr(end + 1);
+        m_digits = end > percent + 1 ? std::stoi(target.substr(percent + 1, end - percent - 1)) : 0;
+    }
+
+    m_target = target;
+    m_fps = fps;
+    m_isOpen = true;
+    m_isClosing = false;
+    m_worker = std::thread(&FrameSink::work, this);
+}
+
+bool FrameSink::isOpen() const{
+    return m_isOpen;
+}
+
+void FrameSink::submit(CanvasObject &canvas){
+    canvas.flush();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_slots.empty()){
+        m_width = canvas.width;
+        m_height = canvas.height;
+        m_slots.resize(FRAME_QUEUE_DEPTH);
+        for(auto &e : m_slots){
+            e.canvas = std::make_unique<CanvasObject>(m_width, m_height);
+            m_free.emplace_back(&e);
+        }
+    }else if(canvas.width != m_width || canvas.height != m_height){
+        throw ParserException("~Error~ Frames must keep the size " + std::to_string(m_width) + "x" + std::to_string(m_height) + ".");
+    }
+
+    m_condition.wait(lock, [this](){ return !m_free.empty() || !m_error.empty(); });
+    if(!m_error.empty()){
+        throw ParserException(m_error);
+    }
+
+    // frameDirty holds every tile changed since the previous frame, it is enough when that frame
+    // was the last one submitted.
+    Slot *slot = m_free.front();
+    m_free.pop_front();
+    slot->isIncremental = &canvas == m_lastCanvas && canvas.frameStats.frames == m_lastFrame + 1;
+    slot->index = m_submitted++;
+    m_lastCanvas = &canvas;
+    m_lastFrame = canvas.frameStats.frames;
+    lock.unlock();
+
+    std::memcpy(slot->canvas->pixels, canvas.pixels, canvas.stride * canvas.height * sizeof(std::uint32_t));
+    if(slot->isIncremental){
+        slot->changed = canvas.frameDirty;
+    }
+
+    lock.lock();
+    m_ready.emplace_back(slot);
+    lock.unlock();
+    m_condition.notify_all();
+}
+
+// Waits for the queued frames and returns how many were written.
+std::size_t FrameSink::close(){
+    if(!m_isOpen){
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isClosing = true;
+    }
+    m_condition.notify_all();
+    m_worker.join();
+
+    std::string error = m_error;
+    if(m_stream){
+        try{
+            m_stream->close();
+        }catch(const Error &e){
+            error = error.empty() ? e.what() : error;
+        }
+    }
+
+    std::size_t written = m_written;
+    m_stream.reset();
+    m_planes.clear();
+    m_slots.clear();
+    m_free.clear();
+    m_ready.clear();
+    m_error.clear();
+    m_submitted = 0;
+    m_written = 0;
+    m_lastCanvas = nullptr;
+    m_lastFrame = 0;
+    m_isOpen = false;
+
+    if(!error.empty()){
+        throw ParserException(error);
+    }
+
+    return written;
+}
+
+void FrameSink::work(){
+    while(true){
+        Slot *slot;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this](){ return !m_ready.empty() || m_isClosing; });
+            if(m_ready.empty()){
+                return;
+            }
+            slot = m_ready.front();
+            m_ready.pop_front();
+        }
+
+        // After an error the remaining frames are dropped, submit() reports it.
+        std::string error;
+        if(m_error.empty()){
+            try{
+                encode(*slot);
+            }catch(const Error &e){
+                error = e.what();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!error.empty()){
+                m_error = error;
+            }else if(m_error.empty()){
+                ++m_written;
+            }
+            m_free.emplace_back(slot);
+        }
+        m_condition.notify_all();
+    }
+}
+
+void FrameSink::encode(Slot &slot){
+    if(m_isY4m){
+        encodeY4m(slot);
+    }else{
+        saveImage(*slot.canvas, framePath(slot.index), m_format);
+    }
+}
+
+std::string FrameSink::framePath(std::size_t index) const{
+    std::string number = std::to_string(index);
+    if(static_cast<int>(number.size()) < m_digits){
+        number.insert(0, m_digits - number.size(), '0');
+    }
+
+    return m_prefix + number + m_suffix;
+}
+
+// Converts the 2x2 blocks of area, which starts on even coordinates. Chroma is the mean of the
+// block, pixels past the right or bottom side repeat the last column or row.
+static void convertToYuv(CanvasObject &canvas, const ClipRect &area, std::uint8_t *luma, std::uint8_t *cb, std::uint8_t *cr){
+    int chromaWidth = (canvas.width + 1) / 2;
+    for(int y = area.y0; y < area.y1; y += 2){
+        const std::uint32_t *rows[2] = {canvas.row(y), canvas.row(std::min(y + 1, canvas.height - 1))};
+        for(int x = area.x0; x < area.x1; x += 2){
+            int columns[2] = {x, std::min(x + 1, canvas.width - 1)};
+            int r = 0, g = 0, b = 0;
+            for(int i = 0; i < 2; ++i){
+                for(int j = 0; j < 2; ++j){
+                    std::uint32_t color = rows[i][columns[j]];
+                    int red = colorChannel(color, 0), green = colorChannel(color, 1), blue = colorChannel(color, 2);
+                    r += red;
+                    g += green;
+                    b += blue;
+                    if(y + i < canvas.height && x + j < canvas.width){
+                        luma[static_cast<std::size_t>(y + i) * canvas.width + x + j] = static_cast<std::uint8_t>(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+                    }
+                }
+            }
+
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            std::size_t index = static_cast<std::size_t>(y / 2) * chromaWidth + x / 2;
+            cb[index] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            cr[index] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+void FrameSink::encodeY4m(Slot &slot){
+    CanvasObject &canvas = *slot.canvas;
+    std::size_t lumaSize = static_cast<std::size_t>(m_width) * m_height;
+    std::size_t chromaSize = static_cast<std::size_t>((m_width + 1) / 2) * ((m_height + 1) / 2);
+    bool isIncremental = slot.isIncremental && !m_planes.empty();
+    if(m_planes.empty()){
+        std::string header = "YUV4MPEG2 W" + std::to_string(m_width) + " H" + std::to_string(m_height) + " F" + std::to_string(m_fps) + ":1 Ip A1:1 C420jpeg\n";
+        m_stream->write(header.data(), header.size());
+        m_planes.resize(lumaSize + chromaSize * 2);
+    }
+
+    std::uint8_t *luma = m_planes.data();
+    std::uint8_t *cb = luma + lumaSize;
+    std::uint8_t *cr = cb + chromaSize;
+    auto convertTileRow = [&](std::size_t tileY){
+        for(int tileX = 0; tileX < canvas.tilesX; ++tileX){
+            if(!isIncremental || slot.changed[tileY * canvas.tilesX + tileX]){
+                int x = tileX * DIRTY_TILE_SIZE;
+                int y = static_cast<int>(tileY) * DIRTY_TILE_SIZE;
+                convertToYuv(canvas, ClipRect{x, y, std::min(x + DIRTY_TILE_SIZE, m_width), std::min(y + DIRTY_TILE_SIZE, m_height)}, luma, cb, cr);
+            }
+        }
+    };
+
+    if(lumaSize < PARALLEL_RASTER_PIXELS || sharedThreadPool().size() == 0){
+        for(int tileY = 0; tileY < canvas.tilesY; ++tileY){
+            convertTileRow(tileY);
+        }
+    }else{
+        sharedThreadPool().parallelFor(canvas.tilesY, convertTileRow);
+    }
+
+    m_stream->write("FRAME\n", 6);
+    m_stream->write(m_planes.data(), m_planes.size());
+}
+
+// Helper Functions
+FrameSink &frameSink(){
+    static FrameSink sink;
+    return sink;
+}
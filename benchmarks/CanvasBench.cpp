@@ -0,0 +1,296 @@
+#include "../headers/Interpreter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+// Times the lexer, the parser and the evaluator on fixed workloads. Every benchmark repeats until
+// it ran for --min-time seconds (at least 5 times) and reports the min, median and mean of one run.
+//
+//   canvas_bench [--filter <text>] [--min-time <seconds>] [--json <file|->] [--compare <file>]
+//
+// --json writes the results as JSON, --compare prints each median against one from an earlier run.
+
+struct Workload{
+    // Variables
+    std::string name;
+    std::string code;
+};
+
+static const std::vector<Workload> &evalWorkloads(){
+    static const std::vector<Workload> workloads = {
+        {"recursion", R"(
+def fib(n){
+    if(n < 2){
+        ret n;
+    }
+
+    ret fib(n - 1) + fib(n - 2);
+}
+
+result = fib(18);
+)"},
+        {"loops", R"(
+total = 0;
+i = 0;
+while(i < 20000){
+    total += i % 7;
+    i += 1;
+}
+for(k = 0;, k < 5000;, k += 1;){
+    total -= 1;
+}
+)"},
+        {"string_building", R"(
+text = "";
+repeat(3000){
+    text = text + "ab";
+}
+parts = "";
+i = 0;
+while(i < 1000){
+    parts += to_str(i);
+    i += 1;
+}
+)"},
+        {"list_indexing", R"(
+values = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31];
+word = "abcdefghijklmnopqrstuvwxyz012345";
+total = 0;
+letters = "";
+repeat(300){
+    i = 0;
+    while(i < 32){
+        total += values[i] * 2;
+        letters = word[i];
+        i += 1;
+    }
+}
+)"},
+        {"builtin_calls", R"(
+color = 0;
+number = 0;
+repeat(3000){
+    color = rgb(10, 20, 30);
+    color = hsla(200, 0.5, 0.5, 1);
+    number = to_num("42");
+}
+)"},
+        {"draw_calls", R"(
+c = canvas(256, 256, "#000000");
+i = 0;
+while(i < 2000){
+    fill_rect(c, i % 200, i % 190, 40, 30, rgba(i % 255, 100, 50, 0.5));
+    line(c, 0, i % 256, 255, 255 - i % 256, "#ffffff");
+    i += 1;
+}
+pixel = get_pixel(c, 10, 10);
+)"}
+    };
+    return workloads;
+}
+
+struct BenchResult{
+    // Variables
+    std::string name;
+    std::size_t iterations;
+    double minNs, medianNs, meanNs;
+};
+
+// setup runs before every timed call and is not measured.
+static BenchResult measure(const std::string &name, double minSeconds, const std::function<void()> &setup, const std::function<void()> &run){
+    std::vector<double> times;
+    double total = 0.0;
+    while(times.size() < 5 || total < minSeconds){
+        setup();
+        auto startTime = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        times.emplace_back(seconds * 1e9);
+        total += seconds;
+    }
+
+    std::sort(times.begin(), times.end());
+    double sum = 0.0;
+    for(double e : times){
+        sum += e;
+    }
+
+    std::size_t middle = times.size() / 2;
+    double median = times.size() % 2 ? times[middle] : (times[middle - 1] + times[middle]) / 2.0;
+    return BenchResult{name, times.size(), times.front(), median, sum / times.size()};
+}
+
+// Programs are one block, as loadFileContentAsCode() wraps a file.
+static std::shared_ptr<AbstractNode> parseCode(const std::string &code){
+    Interpreter interpreter;
+    TreeParser parser;
+    std::vector<Token> tokens = interpreter.lex("{\n" + code + "}", DEFAULT_REGEX_PATTERN);
+    return parser.parse(tokens);
+}
+
+static std::string escapeJson(const std::string &text){
+    std::string escaped;
+    for(char e : text){
+        if(e == '"' || e == '\\'){
+            escaped += '\\';
+        }
+        escaped += e;
+    }
+
+    return escaped;
+}
+
+static void writeJson(std::ostream &stream, const std::vector<BenchResult> &results){
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    stream << "{\n  \"context\": {\"date\": \"" << date << "\", \"optimized\": "
+#ifdef __OPTIMIZE__
+        << "true"
+#else
+        << "false"
+#endif
+        << "},\n  \"benchmarks\": [\n";
+    for(std::size_t i = 0; i < results.size(); ++i){
+        const BenchResult &e = results[i];
+        stream << std::fixed << std::setprecision(0) << "    {\"name\": \"" << escapeJson(e.name) << "\", \"iterations\": " << e.iterations
+            << ", \"min_ns\": " << e.minNs << ", \"median_ns\": " << e.medianNs << ", \"mean_ns\": " << e.meanNs << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    stream << "  ]\n}\n";
+}
+
+// Reads the medians back from a file written by writeJson.
+static std::map<std::string, double> readBaseline(const std::string &path){
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string text = content.str();
+
+    std::map<std::string, double> medians;
+    const std::string nameKey = "\"name\": \"", medianKey = "\"median_ns\": ";
+    for(std::size_t position = text.find(nameKey); position != std::string::npos; position = text.find(nameKey, position)){
+        position += nameKey.size();
+        std::size_t nameEnd = text.find('"', position);
+        std::size_t median = text.find(medianKey, nameEnd);
+        if(nameEnd == std::string::npos || median == std::string::npos){
+            break;
+        }
+        medians[text.substr(position, nameEnd - position)] = std::strtod(text.c_str() + median + medianKey.size(), nullptr);
+    }
+
+    return medians;
+}
+
+int main(int argc, char **argv){
+    std::string filter, jsonPath, baselinePath;
+    double minSeconds = 0.5;
+    for(int i = 1; i < argc; ++i){
+        std::string argument = argv[i];
+        if(i + 1 < argc && argument == "--filter"){
+            filter = argv[++i];
+        }else if(i + 1 < argc && argument == "--min-time"){
+            minSeconds = std::atof(argv[++i]);
+        }else if(i + 1 < argc && argument == "--json"){
+            jsonPath = argv[++i];
+        }else if(i + 1 < argc && argument == "--compare"){
+            baselinePath = argv[++i];
+        }else{
+            std::cerr << "Usage: canvas_bench [--filter <text>] [--min-time <seconds>] [--json <file|->] [--compare <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // The lexer and parser run on every workload back to back, repeated to about 100KB of source.
+    std::string source = "{\n";
+    while(source.size() < 100000){
+        for(const Workload &e : evalWorkloads()){
+            source += e.code;
+        }
+    }
+    source += "}";
+
+    auto isSelected = [&](const std::string &name){
+        return filter.empty() || name.find(filter) != std::string::npos;
+    };
+
+    std::vector<BenchResult> results;
+    try{
+        Interpreter interpreter;
+        if(isSelected("lex")){
+            results.emplace_back(measure("lex", minSeconds, [](){}, [&](){
+                interpreter.lex(source, DEFAULT_REGEX_PATTERN);
+            }));
+        }
+
+        if(isSelected("parse")){
+            const std::vector<Token> tokens = interpreter.lex(source, DEFAULT_REGEX_PATTERN);
+            std::vector<Token> input;
+            results.emplace_back(measure("parse", minSeconds, [&](){ input = tokens; }, [&](){
+                TreeParser parser;
+                parser.parse(input);
+            }));
+        }
+
+        for(const Workload &e : evalWorkloads()){
+            std::string name = "eval/" + e.name;
+            if(!isSelected(name)){
+                continue;
+            }
+
+            // A fresh tree and scope for every run, only the evaluation is timed.
+            std::shared_ptr<AbstractNode> root;
+            std::unique_ptr<ScopeManager> scope;
+            results.emplace_back(measure(name, minSeconds, [&](){
+                scope.reset();
+                scope = std::make_unique<ScopeManager>();
+                root = parseCode(e.code);
+            }, [&](){
+                root->eval(*scope);
+            }));
+        }
+    }catch(const Error &e){
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, double> baseline;
+    if(!baselinePath.empty()){
+        baseline = readBaseline(baselinePath);
+    }
+
+    std::ostream &table = jsonPath == "-" ? std::cerr : std::cout;
+    table << std::left << std::setw(24) << "benchmark" << std::right << std::setw(8) << "runs"
+        << std::setw(14) << "min (us)" << std::setw(14) << "median (us)" << std::setw(14) << "mean (us)"
+        << (baseline.empty() ? "" : "    vs baseline") << std::endl;
+    for(const BenchResult &e : results){
+        table << std::left << std::setw(24) << e.name << std::right << std::setw(8) << e.iterations << std::fixed << std::setprecision(1)
+            << std::setw(14) << e.minNs / 1e3 << std::setw(14) << e.medianNs / 1e3 << std::setw(14) << e.meanNs / 1e3;
+        auto previous = baseline.find(e.name);
+        if(previous != baseline.end() && previous->second > 0.0){
+            double change = (e.medianNs / previous->second - 1.0) * 100.0;
+            table << std::setw(12) << std::showpos << std::setprecision(1) << change << "%" << std::noshowpos;
+        }
+        table << std::endl;
+    }
+
+    if(jsonPath == "-"){
+        writeJson(std::cout, results);
+    }else if(!jsonPath.empty()){
+        std::ofstream file(jsonPath);
+        writeJson(file, results);
+        if(!file){
+            std::cerr << "Could not write \'" << jsonPath << "\'." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
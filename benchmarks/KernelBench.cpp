@@ -0,0 +1,135 @@
+#include "../headers/Kernels.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+
+// Checks every kernel set against the scalar one byte for byte, then reports megapixels per second
+// for each kernel on a 1080p span. Exits with 1 if any set disagrees with the scalar output.
+
+static std::vector<std::uint32_t> randomPixels(std::mt19937 &rng, std::size_t count){
+    std::vector<std::uint32_t> pixels(count);
+    for(auto &e : pixels){
+        e = rng();
+        // Make the alpha edge cases common.
+        switch(rng() % 4){
+        case 0: e |= 0xFF000000; break;
+        case 1: e &= 0x00FFFFFF; break;
+        default: break;
+        }
+    }
+
+    return pixels;
+}
+
+static bool verify(const PixelKernels &kernels){
+    const PixelKernels &scalar = scalarKernels();
+    std::mt19937 rng(7);
+
+    for(int round = 0; round < 2000; ++round){
+        std::size_t count = rng() % 67;
+        std::size_t offset = rng() % 8;
+        std::vector<std::uint32_t> dst = randomPixels(rng, count + offset);
+        std::vector<std::uint32_t> src = randomPixels(rng, count + offset);
+        std::uint32_t color = randomPixels(rng, 1)[0];
+
+        std::vector<std::uint32_t> expected = dst;
+        std::vector<std::uint32_t> actual = dst;
+        scalar.fill(expected.data() + offset, count, color);
+        kernels.fill(actual.data() + offset, count, color);
+        if(expected != actual){
+            std::cout << kernels.name << ": fill differs from scalar" << std::endl;
+            return false;
+        }
+
+        expected = dst;
+        actual = dst;
+        scalar.fillBlend(expected.data() + offset, count, color);
+        kernels.fillBlend(actual.data() + offset, count, color);
+        if(expected != actual){
+            std::cout << kernels.name << ": fillBlend differs from scalar" << std::endl;
+            return false;
+        }
+
+        expected = dst;
+        actual = dst;
+        scalar.copy(expected.data() + offset, src.data(), count);
+        kernels.copy(actual.data() + offset, src.data(), count);
+        if(expected != actual){
+            std::cout << kernels.name << ": copy differs from scalar" << std::endl;
+            return false;
+        }
+
+        expected = dst;
+        actual = dst;
+        scalar.copyBlend(expected.data() + offset, src.data(), count);
+        kernels.copyBlend(actual.data() + offset, src.data(), count);
+        if(expected != actual){
+            std::cout << kernels.name << ": copyBlend differs from scalar" << std::endl;
+            return false;
+        }
+
+        std::vector<std::int32_t> cells(count);
+        for(auto &e : cells){
+            e = static_cast<std::int32_t>(rng() % (2 * COVERAGE_ONE + 1)) - COVERAGE_ONE;
+        }
+        std::int32_t sum = static_cast<std::int32_t>(rng() % (4 * COVERAGE_ONE)) - 2 * COVERAGE_ONE;
+        std::vector<std::uint8_t> expectedAlpha(count), actualAlpha(count);
+        if(scalar.coverage(cells.data(), expectedAlpha.data(), count, sum) != kernels.coverage(cells.data(), actualAlpha.data(), count, sum) || expectedAlpha != actualAlpha){
+            std::cout << kernels.name << ": coverage differs from scalar" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename Function> static double megapixelsPerSecond(std::size_t count, Function function){
+    const int iterations = 200;
+    function();
+
+    auto startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; ++i){
+        function();
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(endTime - startTime).count();
+    return static_cast<double>(count) * iterations / seconds / 1e6;
+}
+
+int main(){
+    const std::size_t count = 1920 * 1080;
+    std::mt19937 rng(1);
+    std::vector<std::uint32_t> src = randomPixels(rng, count);
+    std::vector<std::uint32_t> dst = randomPixels(rng, count);
+    std::vector<std::int32_t> cells(count);
+    std::vector<std::uint8_t> alpha(count);
+    for(std::size_t i = 0; i < count; ++i){
+        cells[i] = (i % 64 == 0) ? COVERAGE_ONE : (i % 64 == 63) ? -COVERAGE_ONE : static_cast<std::int32_t>(rng() % 512) - 256;
+    }
+
+    bool isExact = true;
+    std::cout << std::left << std::setw(8) << "kernels" << std::right
+        << std::setw(12) << "fill" << std::setw(12) << "fillBlend" << std::setw(12) << "copy" << std::setw(12) << "copyBlend" << std::setw(12) << "coverage"
+        << "   (MP/s)" << std::endl;
+
+    for(const PixelKernels *kernels : availableKernels()){
+        bool isKernelExact = verify(*kernels);
+        isExact = isExact && isKernelExact;
+
+        std::cout << std::left << std::setw(8) << kernels->name << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << megapixelsPerSecond(count, [&](){ kernels->fill(dst.data(), count, 0xFF336699); })
+            << std::setw(12) << megapixelsPerSecond(count, [&](){ kernels->fillBlend(dst.data(), count, 0x80336699); })
+            << std::setw(12) << megapixelsPerSecond(count, [&](){ kernels->copy(dst.data(), src.data(), count); })
+            << std::setw(12) << megapixelsPerSecond(count, [&](){ kernels->copyBlend(dst.data(), src.data(), count); })
+            << std::setw(12) << megapixelsPerSecond(count, [&](){ kernels->coverage(cells.data(), alpha.data(), count, 0); })
+            << (isKernelExact ? "   exact" : "   MISMATCH") << std::endl;
+    }
+
+    std::cout << "active: " << activeKernels().name << std::endl;
+
+    return isExact ? 0 : 1;
+}
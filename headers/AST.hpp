@@ -7,6 +7,14 @@
 
 class AbstractNode;
 #include "Interpreter.hpp"
+#include "Isolate.hpp"
+#include "Canvas.hpp"
+#include "Image.hpp"
+#include "Sprite.hpp"
+#include "Assets.hpp"
+#include "Raster.hpp"
+#include "Video.hpp"
+#include "Snapshot.hpp"
 
 enum class NodeType{
     NONE,
@@ -34,9 +42,13 @@ enum class NodeType{
     STR_LIT,
 
     LIB,
-    PTR
+    PTR,
+    OBJ
 };
 
+// --stats counts every kind in an array indexed by NodeType (see Stats.hpp).
+static_assert(static_cast<std::size_t>(NodeType::OBJ) < STATS_NODE_KINDS, "STATS_NODE_KINDS must cover every NodeType");
+
 struct NodeInfo{
     // Variables
     NodeType type;
@@ -56,6 +68,8 @@ class AbstractNode{
     public:
         // Variables
         NodeInfo info;
+        // Source line of a statement, 0 for expressions.
+        unsigned int row = 0;
 
         // Constructor & Destructor
         virtual ~AbstractNode() = default;
@@ -169,10 +183,14 @@ struct DefStatement : public AbstractNode{
 };
 
 struct DefLambdaStatement : public AbstractNode{
+    std::vector<std::string> captures;
+    std::vector<std::string> calleeCaptures;
+
     DefLambdaStatement();
     ~DefLambdaStatement() = default;
 
     NodeInfo eval(ScopeManager &scope) override;
+    void collectCaptures();
 };
 
 struct RetStatement : public AbstractNode{
@@ -194,6 +212,8 @@ struct CallStatement : public AbstractNode{
     ~CallStatement() = default;
 
     NodeInfo eval(ScopeManager &scope) override;
+    NodeInfo evalBuiltin(ScopeManager &scope, const std::string &identifier, std::vector<NodeInfo> &argsList);
+    bool prepareTailCall(ScopeManager &scope);
 };
 
 struct AssignementStatment : public AbstractNode{
@@ -206,9 +226,10 @@ struct AssignementStatment : public AbstractNode{
 };
 
 // Helper Functions
+NodeInfo dataToLiteral(const Data &data);
 NodeInfo identifierToLiteral(NodeInfo info, ScopeManager &scope);
 NodeInfo invoke(ScopeManager &scope, std::string identifier, std::vector<NodeInfo> &argsList);
 NodeInfo invoke(ScopeManager &scope, AbstractNode *ptr, std::vector<NodeInfo> &argsList);
-NodeInfo invokeLambda(ScopeManager &scope, AbstractNode *ptr, std::vector<NodeInfo> &argsList);
+NodeInfo callFunction(ScopeManager &scope, std::string identifier, Data callee, std::vector<NodeInfo> &argsList, std::size_t firstArg);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef ASSETS_HPP
+#define ASSETS_HPP
+
+#include "Canvas.hpp"
+#include <memory>
+#include <unordered_map>
+
+// Cache files start with this header, followed by the entry table, the path strings and the pixel
+// data of every image, each image 64-byte aligned with rows of width * 4 bytes.
+struct AssetCacheHeader{
+    // Variables
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t count;
+};
+
+struct AssetCacheEntry{
+    // Variables
+    std::uint64_t pathOffset;
+    std::uint32_t pathLength;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t reserved;
+    std::uint64_t pixelOffset;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+};
+
+// Pre-decoded images mapped read-only at startup. An entry is used while its source file is
+// missing or unchanged (same size and modification time), otherwise the image is decoded again.
+class AssetCache{
+    private:
+        // Variables
+        const std::uint8_t *m_data = nullptr;
+        std::size_t m_size = 0;
+        std::unordered_map<std::string, const AssetCacheEntry*> m_entries;
+    public:
+        // Variables
+        // Constructor & Destructor
+        AssetCache() = default;
+        ~AssetCache();
+
+        AssetCache(const AssetCache&) = delete;
+        AssetCache &operator=(const AssetCache&) = delete;
+
+        // Functions
+        void open(const std::string &path);
+        std::size_t size() const;
+        std::unique_ptr<CanvasObject> find(const std::string &path, Heap *heap = nullptr) const;
+};
+
+// Helper Functions
+AssetCache &assetCache();
+// Decodes through the cache when it has the image, with a heap the pixels count against its limit.
+std::unique_ptr<CanvasObject> loadImage(const std::string &path, Heap *heap = nullptr);
+std::size_t writeAssetCache(const std::string &cachePath, const std::vector<std::string> &paths);
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef CANVAS_HPP
+#define CANVAS_HPP
+
+#include "Heap.hpp"
+#include "Color.hpp"
+
+// Source-over compositing of a non premultiplied colour onto a pixel.
+inline std::uint32_t blendPixel(std::uint32_t dst, std::uint32_t src){
+    std::uint32_t alpha = colorAlpha(src);
+    std::uint32_t inverse = 255 - alpha;
+    std::uint32_t result = 0;
+    for(int shift = 0; shift < 24; shift += 8){
+        std::uint32_t s = (src >> shift) & 0xFF;
+        std::uint32_t d = (dst >> shift) & 0xFF;
+        result |= div255(s * alpha + d * inverse) << shift;
+    }
+
+    return result | (div255(255 * alpha + colorAlpha(dst) * inverse) << 24);
+}
+
+// Exclusive bounds the primitives are clipped against.
+struct ClipRect{
+    // Variables
+    int x0, y0, x1, y1;
+};
+
+enum class DrawCommandType : std::uint8_t{
+    PIXEL,
+    LINE,
+    RECT,
+    FILL_RECT,
+    CLEAR,
+    BLIT,
+    SHAPE,
+    GRADIENT
+};
+
+// Path coordinates in 24.8 fixed point, pixel (x, y) covers [x, x + 1) x [y, y + 1).
+const int RASTER_SUBPIXELS = 256;
+
+struct FixedPoint{
+    // Variables
+    int x, y;
+};
+
+using Contour = std::vector<FixedPoint>;
+
+// A recorded primitive. Rects, blits, shapes and gradients keep their width and height in x1, y1.
+// A blit keeps the index of its BlitSource in color, shapes and gradients that of their ShapeSource.
+struct DrawCommand{
+    // Variables
+    DrawCommandType type;
+    int x0, y0, x1, y1;
+    std::uint32_t color;
+};
+
+struct CanvasObject;
+
+// The image a recorded blit reads. version is the source's version when it was recorded, so two
+// blits of the same canvas only compare equal if its pixels did not change in between.
+struct BlitSource{
+    // Variables
+    Ref canvas;
+    ClipRect region;
+    std::uint64_t version;
+    bool isBlending;
+};
+
+// What a recorded shape or gradient draws. A shape fills its contours with color, a gradient runs
+// from color to `to` across the command's rect.
+struct ShapeSource{
+    // Variables
+    std::vector<Contour> contours;
+    std::uint32_t color = 0;
+    std::uint32_t to = 0;
+    bool isVertical = false;
+};
+
+// A command as a frame drew it into one tile, blits are resolved to their source so the tile can be
+// compared with the next frame.
+struct RetainedCommand{
+    // Variables
+    DrawCommand command;
+    const CanvasObject *source = nullptr;
+    std::uint64_t version = 0;
+    ClipRect region = {0, 0, 0, 0};
+    bool isBlending = false;
+    std::shared_ptr<const ShapeSource> shape;
+};
+
+struct FrameStats{
+    // Variables
+    std::size_t frames = 0;
+    std::size_t dirtyPixels = 0;
+    std::size_t dirtyTiles = 0;
+    std::size_t redrawnTiles = 0;
+    std::size_t skippedTiles = 0;
+    double milliseconds = 0.0;
+};
+
+// Canvases at least this large rasterise their command list in parallel tiles.
+const std::size_t PARALLEL_RASTER_PIXELS = 1 << 21;
+const int RASTER_TILE_SIZE = 256;
+const std::size_t MAX_PENDING_COMMANDS = 1 << 16;
+// Granularity of dirty tracking and of the frame diff.
+const int DIRTY_TILE_SIZE = 64;
+
+// A headless framebuffer. Rows are padded to a multiple of 64 bytes and the buffer is 64-byte
+// aligned, so every row starts on a cache line. Drawing builtins record commands which are
+// rasterised by flush() before anything reads the pixels; a batch keeps them all pending until it
+// ends so the whole list is coalesced and culled at once.
+//
+// Every change marks the tiles it touches in `dirty` and gives the canvas a new version. A frame is
+// a batch whose commands are binned per tile and compared with the previous frame's, tiles that
+// start with the same opaque cover and draw the same thing are left as they are.
+struct CanvasObject : public HeapObject{
+    // Variables
+    int width;
+    int height;
+    std::size_t stride;
+    std::uint32_t *pixels;
+    std::vector<DrawCommand> pending;
+    std::vector<BlitSource> blitSources;
+    std::vector<std::shared_ptr<const ShapeSource>> shapeSources;
+    bool isBatching = false;
+    bool isFraming = false;
+
+    std::uint64_t version;
+    int tilesX, tilesY;
+    std::vector<std::uint8_t> dirty;
+    std::vector<std::uint8_t> frameDirty;
+    std::vector<std::vector<RetainedCommand>> frameTiles;
+    FrameStats frameStats;
+
+    // Canvases with pending blits that read this one, flushed before it changes.
+    std::vector<CanvasObject*> readers;
+
+    // Constructor & Destructor
+    CanvasObject(int width, int height, std::uint32_t background = 0);
+    ~CanvasObject();
+
+    CanvasObject(const CanvasObject&) = delete;
+    CanvasObject &operator=(const CanvasObject&) = delete;
+
+    // Functions
+    std::size_t byteSize() const override;
+    static std::size_t byteSizeFor(int width, int height);
+
+    std::uint32_t *row(int y){ return pixels + y * stride; }
+    ClipRect bounds() const;
+
+    void setPixel(int x, int y, std::uint32_t color);
+    void drawLine(int x0, int y0, int x1, int y1, std::uint32_t color, const ClipRect &clip);
+    void drawRect(int x, int y, int w, int h, std::uint32_t color, const ClipRect &clip);
+    void fillRect(int x, int y, int w, int h, std::uint32_t color, const ClipRect &clip);
+    void clear(std::uint32_t color, const ClipRect &clip);
+    void blit(CanvasObject &src, const ClipRect &region, int x, int y, bool isBlending, const ClipRect &clip);
+    void fillGradient(int x, int y, int w, int h, std::uint32_t from, std::uint32_t to, bool isVertical, const ClipRect &clip);
+    void drawImage(CanvasObject &src, const ClipRect &region, int x, int y, bool isBlending);
+    void drawShape(std::vector<Contour> contours, std::uint32_t color);
+    void drawGradient(int x, int y, int w, int h, std::uint32_t from, std::uint32_t to, bool isVertical);
+
+    void record(const DrawCommand &command);
+    void execute(const DrawCommand &command, const ClipRect &clip);
+    std::size_t flush();
+
+    void markDirtyTiles(const ClipRect &box);
+    void touch(const ClipRect &box);
+    void flushReaders();
+    void releaseSources();
+
+    void beginFrame();
+    const FrameStats &endFrame();
+};
+
+// Helper Functions
+// Fills count pixels with color, replacing or blending by its alpha through the active kernels.
+void fillSpan(std::uint32_t *dst, int count, std::uint32_t color);
+ClipRect intersect(const ClipRect &a, const ClipRect &b);
+
+void coalesceCommands(std::vector<DrawCommand> &commands);
+void cullOccludedCommands(std::vector<DrawCommand> &commands, const ClipRect &canvasBounds);
+
+int toCoordinate(Data &data);
+CanvasObject *asCanvas(const Data &data, const std::string &identifier);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef CANVAS_API_H
+#define CANVAS_API_H
+
+/*
+ * C interface of the canvas_core library, for hosts that run scripts in process instead of
+ * starting the canvas executable. Only this header is meant to stay stable.
+ *
+ * An interpreter compiles programs and owns the native functions, a program is a parsed script
+ * that can run any number of times, a scope keeps the globals of the programs run in it. Functions
+ * returning int give 0 on success and -1 on failure, canvas_last_error then tells why. An
+ * interpreter and everything made from it is used by one thread at a time.
+ *
+ * Script numbers are 32-bit floats. Numbers passed in as double are rounded to the nearest float,
+ * so integers are exact only up to 2^24 (16777217 reads back as 16777216). Colours are the one
+ * exception: they are packed RGBA words and read back as their exact value.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* canvas_run result when the run used up its steps, time or heap. */
+#define CANVAS_LIMIT_EXCEEDED (-2)
+
+typedef struct canvas_interpreter canvas_interpreter;
+typedef struct canvas_program canvas_program;
+typedef struct canvas_scope canvas_scope;
+typedef struct canvas_call canvas_call;
+
+typedef enum canvas_type{
+    CANVAS_NONE,
+    CANVAS_NUMBER,
+    CANVAS_STRING,
+    CANVAS_FUNCTION,
+    CANVAS_OBJECT
+} canvas_type;
+
+/* Points into the interpreter's own storage, the text is not NUL terminated. */
+typedef struct canvas_string_view{
+    const char *data;
+    size_t size;
+} canvas_string_view;
+
+/* Returns 0, or -1 after canvas_call_error. */
+typedef int (*canvas_native_fn)(canvas_call *call, void *user_data);
+
+canvas_interpreter *canvas_interpreter_new(void);
+void canvas_interpreter_free(canvas_interpreter *interpreter);
+
+/* 0 keeps the default of the canvas executable. */
+void canvas_set_limits(canvas_interpreter *interpreter, size_t max_heap, size_t max_call_depth);
+/* Every run may take max_steps loop iterations and calls and timeout_ms milliseconds, 0 for no limit. */
+void canvas_set_budget(canvas_interpreter *interpreter, unsigned long long max_steps, unsigned long long timeout_ms);
+const char *canvas_last_error(const canvas_interpreter *interpreter);
+
+/* Script functions of the same name shadow a native, a native shadows the builtins. */
+int canvas_register_native(canvas_interpreter *interpreter, const char *name, canvas_native_fn function, void *user_data);
+
+/* Returns NULL on a syntax error. */
+canvas_program *canvas_compile(canvas_interpreter *interpreter, const char *source, size_t size);
+void canvas_program_free(canvas_program *program);
+
+canvas_scope *canvas_scope_new(canvas_interpreter *interpreter);
+void canvas_scope_free(canvas_scope *scope);
+
+/*
+ * Runs the program in a fresh scope when scope is NULL. Otherwise its top level statements run in
+ * the global scope of scope, so their variables and functions are there for the host and for the
+ * next program run in it. The scope keeps the program alive as long as it lives. Returns
+ * CANVAS_LIMIT_EXCEEDED when a limit stopped the run.
+ */
+int canvas_run(canvas_interpreter *interpreter, canvas_program *program, canvas_scope *scope);
+
+/* Globals of a scope, a string view stays valid until the variable changes. */
+canvas_type canvas_get_type(canvas_scope *scope, const char *name);
+int canvas_get_number(canvas_scope *scope, const char *name, double *value);
+int canvas_get_string(canvas_scope *scope, const char *name, canvas_string_view *value);
+int canvas_set_number(canvas_scope *scope, const char *name, double value);
+int canvas_set_string(canvas_scope *scope, const char *name, const char *value, size_t size);
+
+/* Arguments and result of a native call, argument views stay valid until it returns. */
+size_t canvas_arg_count(const canvas_call *call);
+canvas_type canvas_arg_type(const canvas_call *call, size_t index);
+double canvas_arg_number(const canvas_call *call, size_t index);
+canvas_string_view canvas_arg_string(const canvas_call *call, size_t index);
+void canvas_return_number(canvas_call *call, double value);
+void canvas_return_string(canvas_call *call, const char *value, size_t size);
+void canvas_call_error(canvas_call *call, const char *message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
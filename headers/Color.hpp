@@ -0,0 +1,63 @@
+#ifndef COLOR_HPP
+#define COLOR_HPP
+
+#include "Heap.hpp"
+#include <algorithm>
+
+// Pixels are RGBA8, stored as one 32-bit word per pixel with R in the lowest byte. Colour values in
+// scripts are the same word held as an int32, so they are converted once and never parsed again.
+inline std::uint32_t packColor(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255){
+    return static_cast<std::uint32_t>(r) | (static_cast<std::uint32_t>(g) << 8) | (static_cast<std::uint32_t>(b) << 16) | (static_cast<std::uint32_t>(a) << 24);
+}
+
+// Channels given by scripts, 0-255 and alpha as 0-1, are clamped and rounded to the nearest byte.
+inline std::uint8_t toChannel(float value){
+    return value > 0.0f ? static_cast<std::uint8_t>(std::min(value, 255.0f) + 0.5f) : 0;
+}
+
+inline std::uint8_t toAlphaChannel(float alpha){
+    return toChannel(alpha * 255.0f);
+}
+
+inline std::uint8_t colorChannel(std::uint32_t color, int channel){
+    return color >> (channel * 8);
+}
+
+inline std::uint8_t colorAlpha(std::uint32_t color){
+    return color >> 24;
+}
+
+inline Data colorToData(std::uint32_t color){
+    return Data(static_cast<std::int32_t>(color));
+}
+
+// Exact x / 255 for x in [0, 255 * 255].
+inline std::uint32_t div255(std::uint32_t x){
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+// Colour index of count evenly spaced steps from `from` to `to`, both ends included.
+inline std::uint32_t gradientColorAt(std::uint32_t from, std::uint32_t to, std::size_t index, std::size_t count){
+    std::uint32_t t = count > 1 ? static_cast<std::uint32_t>((index * 255 + (count - 1) / 2) / (count - 1)) : 0;
+    std::uint32_t color = 0;
+    for(int channel = 0; channel < 4; ++channel){
+        color |= div255(colorChannel(from, channel) * (255 - t) + colorChannel(to, channel) * t) << (channel * 8);
+    }
+
+    return color;
+}
+
+// Hue in degrees, saturation, lightness and alpha in [0, 1].
+std::uint32_t hslToColor(float h, float s, float l, float a = 1.0f);
+void colorToHsl(std::uint32_t color, float &h, float &s, float &l);
+std::string colorToHex(std::uint32_t color);
+
+// Batch conversion of structure-of-arrays HSL(A) values, vectorised where the CPU allows.
+void hslToColors(const float *h, const float *s, const float *l, const float *a, std::uint32_t *out, std::size_t count);
+
+void gradientColors(std::uint32_t from, std::uint32_t to, std::uint32_t *out, std::size_t count);
+
+// Helper Functions
+std::uint32_t parseColor(const Data &data);
+
+#endif
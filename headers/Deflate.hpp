@@ -0,0 +1,25 @@
+#ifndef DEFLATE_HPP
+#define DEFLATE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// The deflate window, a strip may refer back this far into the bytes before it.
+const std::size_t DEFLATE_WINDOW = 32768;
+
+// Compresses data[start, end) as raw deflate blocks appended to out. The up to DEFLATE_WINDOW bytes
+// before start are used as history, so consecutive strips can be compressed on separate threads and
+// concatenated. A strip that is not final ends byte aligned with an empty stored block.
+void deflateStrip(const std::uint8_t *data, std::size_t start, std::size_t end, bool isFinal, std::vector<std::uint8_t> &out);
+
+// Decompresses a zlib stream (RFC 1950) and checks its Adler-32, throws on corrupt input or once
+// more than limit bytes would be produced.
+void inflateZlib(const std::uint8_t *data, std::size_t size, std::vector<std::uint8_t> &out, std::size_t limit = SIZE_MAX);
+
+// Helper Functions
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size, std::uint32_t crc = 0);
+std::uint32_t adler32(const std::uint8_t *data, std::size_t size, std::uint32_t adler = 1);
+std::uint32_t adler32Combine(std::uint32_t first, std::uint32_t second, std::size_t secondSize);
+
+#endif
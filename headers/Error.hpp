@@ -32,6 +32,20 @@ struct ParserException : public Error{
 		virtual const char* what() const noexcept;
 };
 
+// Thrown when a run used up its steps, time or heap, see ExecutionLimits.
+struct LimitError : public Error{
+	protected:
+		// Variables
+	public:
+		// Variables
+		// Constructor & Destructor
+		LimitError(std::string msg);
+		~LimitError() = default;
+
+		// Functions
+		virtual const char* what() const noexcept;
+};
+
 struct SyntaxError : public Error{
 	protected:
 		// Variables
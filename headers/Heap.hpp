@@ -0,0 +1,221 @@
+#ifndef HEAP_HPP
+#define HEAP_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <variant>
+#include <memory>
+#include <ostream>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include "Memory.hpp"
+
+enum class HeapObjectType{
+    NONE,
+
+    LIST,
+    CLOSURE,
+    UPVALUE,
+    CANVAS,
+    SPRITE
+};
+
+enum class HeapColor : std::uint8_t{
+    BLACK,
+    GRAY,
+    WHITE,
+    PURPLE
+};
+
+class Heap;
+class SymbolTable;
+class AbstractNode;
+
+class HeapObject{
+    public:
+        // Variables
+        HeapObjectType kind;
+        std::uint32_t refCount = 0;
+        std::size_t size = 0;
+        Heap *heap = nullptr;
+        HeapColor color = HeapColor::BLACK;
+        bool isBuffered = false;
+
+        // Constructor & Destructor
+        HeapObject(HeapObjectType kind);
+        virtual ~HeapObject() = default;
+
+        // Functions
+        bool isContainer() const;
+        virtual std::size_t byteSize() const = 0;
+        virtual void forEachRef(const std::function<void(HeapObject*)> &visitor);
+        virtual void clearRefs();
+        virtual void dropRefs();
+};
+
+class Ref{
+    private:
+        // Variables
+        HeapObject *m_object;
+    public:
+        // Constructor & Destructor
+        Ref() : m_object(nullptr){}
+        explicit Ref(HeapObject *object) : m_object(object){ incRef(); }
+        Ref(const Ref &other) : m_object(other.m_object){ incRef(); }
+        Ref(Ref &&other) noexcept : m_object(other.m_object){ other.m_object = nullptr; }
+        ~Ref(){ decRef(); }
+
+        // Functions
+        Ref &operator=(const Ref &other);
+        Ref &operator=(Ref &&other) noexcept;
+        explicit operator bool() const{ return m_object != nullptr; }
+
+        HeapObject *get() const{ return m_object; }
+        template<typename T> T *as() const{ return static_cast<T*>(m_object); }
+        HeapObject *release();
+
+        void incRef(){ if(m_object != nullptr) ++m_object->refCount; }
+        void decRef();
+};
+
+bool operator==(const Ref &left, const Ref &right);
+bool operator!=(const Ref &left, const Ref &right);
+bool operator<(const Ref &left, const Ref &right);
+bool operator>(const Ref &left, const Ref &right);
+bool operator<=(const Ref &left, const Ref &right);
+bool operator>=(const Ref &left, const Ref &right);
+std::ostream &operator<<(std::ostream &stream, const Ref &ref);
+
+using Data = std::variant<void*, std::int32_t, float, std::string, Ref>;
+
+struct ListObject : public HeapObject{
+    // Variables
+    std::vector<Data> elements;
+
+    // Constructor & Destructor
+    ListObject(std::vector<Data> elements);
+    ~ListObject() = default;
+
+    // Functions
+    std::size_t byteSize() const override;
+    // Size of a list of count numbers, strings add their own bytes.
+    static std::size_t byteSizeFor(std::size_t count);
+    void forEachRef(const std::function<void(HeapObject*)> &visitor) override;
+    void clearRefs() override;
+    void dropRefs() override;
+};
+
+// An upvalue points at a variable slot of a live SymbolTable while it is open; once the table is
+// destroyed the value is moved into the upvalue itself so closures can keep using it.
+struct UpvalueObject : public HeapObject{
+    // Variables
+    Data *slot;
+    Data closed;
+
+    // Constructor & Destructor
+    UpvalueObject(Data *slot);
+    ~UpvalueObject() = default;
+
+    // Functions
+    void close();
+    std::size_t byteSize() const override;
+    void forEachRef(const std::function<void(HeapObject*)> &visitor) override;
+    void clearRefs() override;
+    void dropRefs() override;
+};
+
+struct ClosureObject : public HeapObject{
+    // Variables
+    AbstractNode *node;
+    std::vector<std::pair<std::string, Ref>> upvalues;
+    std::weak_ptr<SymbolTable> definitionScope;
+
+    // Constructor & Destructor
+    ClosureObject(AbstractNode *node, std::vector<std::pair<std::string, Ref>> upvalues, std::weak_ptr<SymbolTable> definitionScope);
+    ~ClosureObject() = default;
+
+    // Functions
+    std::size_t byteSize() const override;
+    void forEachRef(const std::function<void(HeapObject*)> &visitor) override;
+    void clearRefs() override;
+    void dropRefs() override;
+};
+
+struct HeapStats{
+    // Variables
+    std::size_t liveObjects = 0;
+    std::size_t liveBytes = 0;
+    std::size_t peakBytes = 0;
+    std::size_t totalAllocations = 0;
+    std::size_t totalFrees = 0;
+    std::size_t collections = 0;
+    std::size_t cyclesFreed = 0;
+};
+
+class Heap{
+    private:
+        // Variables
+        HeapStats m_stats;
+        std::size_t m_limit;
+        std::size_t m_collectThreshold;
+        std::vector<HeapObject*> m_roots;
+        std::shared_ptr<std::atomic<std::size_t>> m_account;
+
+        // Functions
+        void free(HeapObject *object);
+        bool fits(std::size_t bytes);
+        std::size_t usedBytes() const;
+        void addBytes(std::size_t bytes);
+        void removeBytes(std::size_t bytes);
+        void markGray(HeapObject *object);
+        void scan(HeapObject *object);
+        void scanBlack(HeapObject *object);
+        void collectWhite(HeapObject *object, std::vector<HeapObject*> &garbage);
+    public:
+        // Variables
+        // Constructor & Destructor
+        Heap();
+        ~Heap();
+
+        // Functions
+        template<typename T, typename... Args> Ref make(Args&&... args){
+            MemoryScope memory(MemoryCategory::OBJECTS);
+            return manage(new T(std::forward<Args>(args)...));
+        }
+        Ref manage(HeapObject *object);
+        void reserve(std::size_t bytes);
+        void release(HeapObject *object);
+        void possibleRoot(HeapObject *object);
+        std::size_t collect();
+
+        void detach(HeapObject *object);
+        Ref adopt(HeapObject *object);
+
+        void setLimit(std::size_t bytes);
+        std::size_t getLimit() const;
+        std::shared_ptr<std::atomic<std::size_t>> getAccount();
+        void shareAccount(std::shared_ptr<std::atomic<std::size_t>> account);
+        const HeapStats &getStats() const;
+};
+
+// Ref release is inlined as it runs on every copy of a heap value.
+inline void Ref::decRef(){
+    if(m_object == nullptr){
+        return;
+    }
+
+    if(--m_object->refCount == 0){
+        if(m_object->heap != nullptr){
+            m_object->heap->release(m_object);
+        }else{
+            delete m_object;
+        }
+    }else if(m_object->heap != nullptr){
+        m_object->heap->possibleRoot(m_object);
+    }
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include "Canvas.hpp"
+#include <cstdio>
+#include <memory>
+
+enum class ImageFormat{
+    PPM,
+    BMP,
+    PNG
+};
+
+// Writes straight to the file descriptor in large chunks. Encoders fill the buffer in place through
+// claim/commit, so pixels are converted once into the bytes that reach the file.
+class FileWriter{
+    private:
+        // Variables
+        std::FILE *m_file;
+        std::string m_path;
+        std::vector<std::uint8_t> m_buffer;
+        std::size_t m_size = 0;
+        std::size_t m_written = 0;
+    public:
+        // Variables
+        // Constructor & Destructor
+        FileWriter(const std::string &path, std::size_t capacity = 1 << 20);
+        // Takes ownership of an already open stream, name is only used in messages.
+        FileWriter(std::FILE *file, const std::string &name, std::size_t capacity = 1 << 20);
+        ~FileWriter();
+
+        FileWriter(const FileWriter&) = delete;
+        FileWriter &operator=(const FileWriter&) = delete;
+
+        // Functions
+        std::uint8_t *claim(std::size_t bytes);
+        void commit(std::size_t bytes);
+        void write(const void *data, std::size_t bytes);
+        void flush();
+        void close();
+        std::size_t written() const;
+};
+
+// Encoders, each returns the number of bytes written.
+std::size_t savePpm(CanvasObject &canvas, const std::string &path);
+std::size_t saveBmp(CanvasObject &canvas, const std::string &path);
+std::size_t savePng(CanvasObject &canvas, const std::string &path);
+
+// Largest image a decoder accepts, 16384x16384 or 1 GiB of pixels.
+const std::int64_t MAX_IMAGE_PIXELS = static_cast<std::int64_t>(1) << 28;
+
+// Decoders for binary PPM (P6), uncompressed 24/32-bit BMP and non interlaced PNG of any colour
+// type and bit depth. decodeImage picks one from the file signature. With a heap the pixels are
+// reserved against its limit before they are allocated.
+std::unique_ptr<CanvasObject> decodePpm(const std::uint8_t *data, std::size_t size, Heap *heap = nullptr);
+std::unique_ptr<CanvasObject> decodeBmp(const std::uint8_t *data, std::size_t size, Heap *heap = nullptr);
+std::unique_ptr<CanvasObject> decodePng(const std::uint8_t *data, std::size_t size, Heap *heap = nullptr);
+std::unique_ptr<CanvasObject> decodeImage(const std::uint8_t *data, std::size_t size, const std::string &path, Heap *heap = nullptr);
+std::unique_ptr<CanvasObject> loadImageFile(const std::string &path, Heap *heap = nullptr);
+
+// Helper Functions
+ImageFormat parseImageFormat(const std::string &path, const std::string &format);
+std::size_t saveImage(CanvasObject &canvas, const std::string &path, ImageFormat format);
+
+#endif
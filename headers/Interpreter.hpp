@@ -4,9 +4,13 @@
 #include "AST.hpp"
 #include "CommonLibs.hpp"
 #include "ResManager.hpp"
+#include "Program.hpp"
 #include "Token.hpp"
 #include "Error.hpp"
 
+// Token pattern of the lexer.
+extern const std::string DEFAULT_REGEX_PATTERN;
+
 class TreeParser{
     private:
         // Variables
@@ -69,6 +73,7 @@ class Interpreter{
 
         // Functions
         RET_CODE execute(std::string &str, ScopeManager &scope, DebugType debugType = DebugType::NONE);
+        std::shared_ptr<const Program> compile(const std::string &str);
         std::vector<Token> lex(const std::string &str, const std::string &pattern);
 
         std::shared_ptr<AbstractNode> getExecutedRoot();
@@ -0,0 +1,83 @@
+#ifndef ISOLATE_HPP
+#define ISOLATE_HPP
+
+#include "CommonLibs.hpp"
+#include "ResManager.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+struct NodeInfo;
+
+enum class ValueTag : std::uint8_t{
+    NONE,
+
+    NUM_INT,
+    NUM_FLOAT,
+    STR,
+    LIST,
+    TRANSFER
+};
+
+struct Message{
+    // Variables
+    std::string payload;
+    std::vector<std::unique_ptr<HeapObject>> transfers;
+};
+
+class MessageQueue{
+    private:
+        // Variables
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Message> m_messages;
+        bool m_isClosed = false;
+    public:
+        // Variables
+        // Constructor & Destructor
+        MessageQueue() = default;
+        ~MessageQueue() = default;
+
+        // Functions
+        void push(Message &&message);
+        bool pop(Message &message);
+        void close();
+};
+
+class Isolate{
+    private:
+        // Variables
+        std::string m_fileName;
+        ExecutionLimits m_limits;
+        std::thread m_thread;
+        RET_CODE m_exitCode;
+
+        // Functions
+        void run();
+    public:
+        // Variables
+        MessageQueue inbox;
+        MessageQueue outbox;
+
+        // Constructor & Destructor
+        Isolate(std::string fileName, ExecutionLimits limits = ExecutionLimits());
+        ~Isolate();
+
+        // Functions
+        void start();
+        RET_CODE join();
+};
+
+// Serialisation
+void serializeValue(const Data &data, Message &message);
+void transferValue(NodeInfo &info, Data *binding, Message &message);
+NodeInfo deserializeValue(Message &message, std::size_t &offset, ScopeManager &scope);
+
+// Helper Functions
+unsigned int spawnIsolate(ScopeManager &scope, const std::string &fileName);
+Isolate *findIsolate(ScopeManager &scope, NodeInfo &handle);
+MessageQueue &findSendQueue(ScopeManager &scope, std::vector<NodeInfo> &argsList, const std::string &identifier);
+MessageQueue &findReceiveQueue(ScopeManager &scope, std::vector<NodeInfo> &argsList, const std::string &identifier);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+// Coverage is accumulated in 16.16 fixed point, this much is a fully covered pixel.
+const std::int32_t COVERAGE_ONE = 1 << 16;
+
+// Non-zero rule, the magnitude of the winding sum clamped to one pixel and scaled to 0-255.
+inline std::uint8_t coverageToAlpha(std::int32_t sum){
+    std::int32_t covered = std::min(sum < 0 ? -sum : sum, COVERAGE_ONE);
+    return static_cast<std::uint8_t>(((covered << 8) - covered + (COVERAGE_ONE >> 1)) >> 16);
+}
+
+// Bulk pixel operations on RGBA8 spans. Every implementation must produce the same bytes as the
+// scalar one (blending uses the exact div255 of blendPixel), only the speed differs.
+struct PixelKernels{
+    // Variables
+    const char *name;
+    void (*fill)(std::uint32_t *dst, std::size_t count, std::uint32_t color);
+    void (*fillBlend)(std::uint32_t *dst, std::size_t count, std::uint32_t color);
+    void (*copy)(std::uint32_t *dst, const std::uint32_t *src, std::size_t count);
+    void (*copyBlend)(std::uint32_t *dst, const std::uint32_t *src, std::size_t count);
+    // Prefix sums signed coverage cells starting from sum into 0-255 alphas, returns the last sum.
+    std::int32_t (*coverage)(const std::int32_t *cells, std::uint8_t *alpha, std::size_t count, std::int32_t sum);
+};
+
+// Helper Functions
+const PixelKernels &scalarKernels();
+std::vector<const PixelKernels*> availableKernels();
+
+// The fastest set supported by the CPU, picked once on first use.
+const PixelKernels &activeKernels();
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// What an allocation was made for. Every operator new of the process is accounted to the category
+// its thread is in at that moment (see MemoryScope) and given back to it on delete. The operator
+// new and delete replacements live in MemoryHooks.cpp, which only the executables link: a host
+// embedding canvas_core keeps its own allocator and the figures stay zero.
+enum class MemoryCategory : std::uint8_t{
+    OTHER,
+
+    TOKENS,
+    AST,
+    SCOPES,
+    VALUES,
+    OBJECTS,
+    PIXELS,
+
+    COUNT
+};
+
+struct MemoryUsage{
+    // Variables
+    std::size_t current = 0;
+    std::size_t peak = 0;
+    std::size_t allocations = 0;
+};
+
+// Accounts the allocations of the current thread to a category until the scope ends.
+class MemoryScope{
+    private:
+        // Variables
+        MemoryCategory m_previous;
+    public:
+        // Variables
+        // Constructor & Destructor
+        MemoryScope(MemoryCategory category);
+        ~MemoryScope();
+
+        MemoryScope(const MemoryScope&) = delete;
+        MemoryScope &operator=(const MemoryScope&) = delete;
+};
+
+// Helper Functions
+MemoryCategory currentMemoryCategory();
+void countMemory(MemoryCategory category, std::int64_t bytes, std::int64_t allocations);
+
+const char *memoryCategoryName(MemoryCategory category);
+MemoryUsage memoryUsage(MemoryCategory category);
+MemoryUsage totalMemoryUsage();
+void writeMemoryReport(std::ostream &stream);
+
+#endif
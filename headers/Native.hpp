@@ -0,0 +1,31 @@
+#ifndef NATIVE_HPP
+#define NATIVE_HPP
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct NodeInfo;
+class ScopeManager;
+
+// A function the embedding host provides, called like a builtin with the evaluated arguments.
+// Script functions of the same name shadow it, it shadows the builtins.
+using NativeFunction = std::function<NodeInfo(ScopeManager&, std::vector<NodeInfo>&)>;
+
+class NativeRegistry{
+    private:
+        // Variables
+        std::unordered_map<std::string, NativeFunction> m_functions;
+    public:
+        // Variables
+        // Constructor & Destructor
+        NativeRegistry() = default;
+        ~NativeRegistry() = default;
+
+        // Functions
+        void add(const std::string &name, NativeFunction function);
+        const NativeFunction *find(const std::string &name) const;
+};
+
+#endif
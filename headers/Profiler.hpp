@@ -0,0 +1,100 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class ProfileMode{
+    SAMPLE,
+    INSTRUMENT
+};
+
+const int DEFAULT_PROFILE_INTERVAL_US = 1000;
+const std::size_t PROFILE_TOP_COUNT = 15;
+
+// Attributes the run time of a script to its functions and source lines.
+//
+// The interpreter publishes its call stack as (function, line) pairs in an array of atomics:
+// enter() and leave() follow the calls and line() stores the row of every statement into the top
+// entry. A sampler thread copies that stack every interval and counts identical stacks, the
+// interpreter never waits for it. Call counts are always exact; INSTRUMENT also times every call,
+// which costs two clock reads per call. Samples are taken on wall time, so waits count as well.
+class Profiler{
+    private:
+        struct FunctionTiming{
+            // Variables
+            std::uint64_t calls = 0;
+            std::size_t active = 0;
+            double inclusive = 0.0;
+            double self = 0.0;
+        };
+
+        struct ActiveCall{
+            // Variables
+            std::chrono::steady_clock::time_point start;
+            double children = 0.0;
+        };
+
+        // Variables
+        ProfileMode m_mode;
+        std::chrono::microseconds m_interval;
+        std::size_t m_capacity;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> m_frames;
+        std::atomic<std::size_t> m_depth;
+
+        // Interpreter thread only
+        std::size_t m_top = 0;
+        std::uint32_t m_topId = 0;
+        std::unordered_map<std::string, std::uint32_t> m_ids;
+        std::vector<std::string> m_names;
+        std::vector<FunctionTiming> m_functions;
+        std::vector<ActiveCall> m_calls;
+        std::chrono::steady_clock::time_point m_startTime;
+        double m_seconds = 0.0;
+
+        // Sampler thread only while running
+        std::map<std::vector<std::uint64_t>, std::size_t> m_stacks;
+        std::size_t m_samples = 0;
+
+        std::thread m_sampler;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_isRunning = false;
+
+        // Functions
+        void sample();
+        std::string frameName(std::uint64_t frame) const;
+    public:
+        // Variables
+        // Constructor & Destructor
+        Profiler(ProfileMode mode, std::size_t maxCallDepth, int intervalUs = DEFAULT_PROFILE_INTERVAL_US);
+        ~Profiler();
+
+        Profiler(const Profiler&) = delete;
+        Profiler &operator=(const Profiler&) = delete;
+
+        // Functions
+        void start();
+        void stop();
+
+        void enter(const std::string &name);
+        void leave();
+        void line(unsigned int row){
+            m_frames[m_top].store(static_cast<std::uint64_t>(m_topId) << 32 | row, std::memory_order_relaxed);
+        }
+
+        void writeCollapsed(std::ostream &stream) const;
+        void writeReport(std::ostream &stream, std::size_t topCount = PROFILE_TOP_COUNT) const;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef PROGRAM_HPP
+#define PROGRAM_HPP
+
+#include "ResManager.hpp"
+
+class AbstractNode;
+
+// Globals a run starts with, set before its first statement.
+using Bindings = std::vector<std::pair<std::string, Data>>;
+
+// A parsed script. Evaluating never changes the tree, so one Program is shared by any number of
+// runs, on any threads, each with a ScopeManager of its own. Functions point into the tree, so load
+// registers it with a scope before anything of it runs there outside of run.
+class Program{
+    private:
+        // Variables
+        std::shared_ptr<AbstractNode> m_root;
+        std::shared_ptr<const std::string> m_code;
+    public:
+        // Variables
+        // Constructor & Destructor
+        Program(std::shared_ptr<AbstractNode> root, std::shared_ptr<const std::string> code);
+        ~Program() = default;
+
+        // Functions
+        void load(ScopeManager &scope) const;
+        void run(ScopeManager &scope, const Bindings &bindings = {}) const;
+        const std::vector<std::shared_ptr<AbstractNode>> &getStatements() const;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef RASTER_HPP
+#define RASTER_HPP
+
+#include "Canvas.hpp"
+
+// Fills closed contours with the non-zero rule and anti-aliased edges. Every edge adds its exact
+// signed area to a sparse cell buffer covering only the bounding box, then each row is prefix
+// summed into coverage by the active kernels and composited in runs, so interiors become plain
+// span fills. Shapes are recorded by drawShape, this only writes the pixels inside clip.
+void fillContours(CanvasObject &canvas, const std::vector<Contour> &contours, std::uint32_t color, const ClipRect &clip);
+
+// Path builders, the contours all wind the same way so overlapping parts merge instead of cancel.
+FixedPoint toFixedPoint(float x, float y);
+Contour circleContour(float cx, float cy, float radius, bool isReversed = false);
+Contour polygonContour(const std::vector<float> &coordinates);
+std::vector<Contour> strokeContours(const std::vector<float> &coordinates, float width, bool isClosed);
+
+#endif
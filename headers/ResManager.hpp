@@ -2,9 +2,43 @@
 #define RES_MANAGER_HPP
 
 #include "CommonLibs.hpp"
+#include "Heap.hpp"
+#include "Native.hpp"
+#include "Profiler.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
 #include <stack>
 
-using Data = std::variant<void*, std::int32_t, float, std::string>;
+// Calls are tracked on an explicit stack instead of relying on the native one, the interpreter
+// thread's native stack is sized from this depth (see nativeStackSizeFor).
+const std::size_t DEFAULT_MAX_CALL_DEPTH = 10000;
+const std::size_t NATIVE_STACK_PER_CALL = 16 * 1024;
+
+// Steps between two looks at the clock or the shared step account while a limit is set.
+const std::uint64_t TIMEOUT_CHECK_STEPS = 4096;
+
+// Limits of a run, 0 for none. A step is a loop iteration or a function call, the timeout counts
+// from the moment the limits are applied. The accounts are set by remainingLimits, so an isolate
+// charges its heap and steps to the script that spawned it instead of getting limits of its own.
+struct ExecutionLimits{
+    // Variables
+    std::size_t maxHeap = 0;
+    std::size_t maxCallDepth = DEFAULT_MAX_CALL_DEPTH;
+    std::uint64_t maxSteps = 0;
+    std::chrono::milliseconds timeout{0};
+    std::shared_ptr<std::atomic<std::size_t>> heapAccount;
+    std::shared_ptr<std::atomic<std::uint64_t>> stepAccount;
+};
+
+// How the last evaluated statement completed, blocks stop at anything but NORMAL and loops, calls
+// consume the kinds meant for them.
+enum class Completion{
+    NORMAL,
+
+    RETURN,
+    BREAK,
+    CONTINUE
+};
 
 enum SymbolSearchType{
     NONE,
@@ -18,34 +52,85 @@ class SymbolTable{
         // Variables
         std::shared_ptr<SymbolTable> m_parent;
         std::unordered_map<std::string, Data> m_table;
+        std::unordered_map<std::string, Ref> m_upvalues;
+        std::unordered_map<std::string, Ref> m_openUpvalues;
     public:
         // Variables
         // Constructor & Destructor
         SymbolTable(std::shared_ptr<SymbolTable> m_parent = nullptr);
-        ~SymbolTable() = default;
+        ~SymbolTable();
 
         // Functions
         void push(const std::string& name, const Data &value);
         Data *find(const std::string& name, SymbolSearchType type = SymbolSearchType::RECURSIVE_SCOPE);
 
+        void bindUpvalue(const std::string &name, const Ref &upvalue);
+        Ref captureUpvalue(const std::string &name, Heap &heap);
+        bool definesOnly(const std::function<bool(const std::string&)> &isListed) const;
+
         std::shared_ptr<SymbolTable> getParent();
         std::unordered_map<std::string, Data> &getData();
 };
 
 class AbstractNode;
+class Isolate;
+
+struct CallFrame{
+    // Variables
+    std::string name;
+    std::shared_ptr<SymbolTable> callerScope;
+};
+
+// A parsed source and its text, kept so snapshots can name the functions defined in it.
+struct LoadedSource{
+    // Variables
+    std::shared_ptr<const std::string> code;
+    std::shared_ptr<AbstractNode> root;
+};
+
+// scope is where the returning call made it, the tail-called function is seen from there.
+struct TailCall{
+    // Variables
+    std::string name;
+    Data callee;
+    std::vector<Data> args;
+    std::shared_ptr<SymbolTable> scope;
+};
 
 class ScopeManager{
     private:
         // Variables
+        Heap m_heap;
         std::shared_ptr<SymbolTable> m_globalScope;
         std::shared_ptr<SymbolTable> m_currentScope;
         std::unordered_map<std::string, std::shared_ptr<AbstractNode>> m_libs;
 
+        std::uint64_t m_steps = 0;
+        std::uint64_t m_chargedSteps = 0;
+        std::uint64_t m_maxSteps = 0;
+        std::shared_ptr<std::atomic<std::uint64_t>> m_stepAccount;
+        std::uint64_t m_nextLimitCheck = UINT64_MAX;
+        std::chrono::milliseconds m_timeout{0};
+        std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+
+        // Functions
+        void checkLimits();
     public:
         // Variables
         std::stack<Data> globalStack;
         std::vector<std::string> globalImportStack;
-        bool isReturning = false;
+        Completion completion = Completion::NORMAL;
+
+        std::vector<CallFrame> callStack;
+        std::size_t maxCallDepth = DEFAULT_MAX_CALL_DEPTH;
+        TailCall tailCall;
+        bool isTailCalling = false;
+
+        Isolate *isolate = nullptr;
+        std::vector<std::shared_ptr<Isolate>> isolates;
+        Profiler *profiler = nullptr;
+        const NativeRegistry *natives = nullptr;
+        std::vector<LoadedSource> sources;
         
         // Constructor & Destructor
         ScopeManager();
@@ -55,13 +140,59 @@ class ScopeManager{
         void pushLib(std::string libName, std::shared_ptr<AbstractNode> node);
         std::shared_ptr<AbstractNode> findLib(std::string libName);
 
+        Heap &getHeap();
+
         void pushData(const std::string &name, const Data &value);
         Data *findData(const std::string &name, SymbolSearchType type = SymbolSearchType::RECURSIVE_SCOPE);
 
         void pushScope();
         void popScope();
 
+        std::shared_ptr<SymbolTable> pushFrame(std::shared_ptr<SymbolTable> parent);
+        void popFrame(std::shared_ptr<SymbolTable> previousScope);
+        std::shared_ptr<SymbolTable> getCurrentScope();
+        std::shared_ptr<SymbolTable> getGlobalScope();
+        Ref captureUpvalue(const std::string &name);
+
+        bool endsLoop();
+
+        void enterCall(const std::string &name);
+        void leaveCall();
+        void unwind();
+
+        void applyLimits(const ExecutionLimits &limits);
+        ExecutionLimits remainingLimits();
+        // Counts a step, the limits are only looked at every so often.
+        inline void step(){
+            if(++m_steps >= m_nextLimitCheck){
+                checkLimits();
+            }
+        }
+
         void debug_outScopes();
 };
 
+// Keeps a call entered for its lifetime and restores the caller's scope when it ends, errors
+// included, so the call stack, the profiler and the trace never keep frames of a failed call.
+class CallGuard{
+    private:
+        // Variables
+        ScopeManager &m_scope;
+        std::shared_ptr<SymbolTable> m_callerScope;
+        bool m_isEntered = false;
+    public:
+        // Variables
+        // Constructor & Destructor
+        CallGuard(ScopeManager &scope, const std::string &name);
+        ~CallGuard();
+
+        CallGuard(const CallGuard&) = delete;
+        CallGuard &operator=(const CallGuard&) = delete;
+
+        // Functions
+        // Leaves the call and enters the next one, for tail calls reusing the frame.
+        void reenter(const std::string &name);
+        std::shared_ptr<SymbolTable> getCallerScope() const;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Interpreter.hpp"
+
+// Parsed programs a --serve daemon keeps, keyed by their source, the oldest one goes first.
+const std::size_t SERVE_PROGRAM_CACHE = 64;
+
+// Time a client gets to send its script and shut down its side, and to take the reply.
+const int SERVE_CLIENT_TIMEOUT_MS = 10000;
+
+// Reads statements from stdin and runs them in one global scope, so variables and functions stay
+// defined between inputs. An input continues over lines while braces are open, the values of bare
+// expressions are printed. Every input gets the whole of the limits.
+int runRepl(const ExecutionLimits &limits);
+
+// Runs scripts sent over a unix socket, one connection at a time: the client writes the source and
+// shuts down its side, the reply is everything the script printed. Every script gets a fresh scope
+// and the limits, while parsed programs, mapped assets and the thread pool stay warm between them.
+// Frame output and trace regions a script left open are closed after it.
+int runServer(const std::string &socketPath, const ExecutionLimits &limits);
+
+// Sends a script to a --serve daemon and prints the reply.
+int runClient(const std::string &socketPath, const std::string &fileName);
+
+#endif
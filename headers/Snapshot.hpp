@@ -0,0 +1,80 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "ResManager.hpp"
+
+// A snapshot starts with this header, followed by the source, object and variable tables and the
+// data section they point into. Offsets count from the start of the data section and nodes are
+// named by their position in their tree, so the image can be mapped anywhere and read in place.
+struct SnapshotHeader{
+    // Variables
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t sourceCount;
+    std::uint32_t objectCount;
+    std::uint32_t variableCount;
+    std::uint64_t dataOffset;
+};
+
+enum class SnapshotTag : std::uint8_t{
+    NONE,
+
+    INT,
+    FLOAT,
+    STRING,
+    OBJECT,
+    FUNCTION
+};
+
+// INT keeps its value in payload, FLOAT the bits in index, STRING the offset in payload and the
+// length in index, OBJECT the object in index, FUNCTION the source in index and the node in payload.
+struct SnapshotValue{
+    // Variables
+    SnapshotTag tag;
+    std::uint8_t reserved[3];
+    std::uint32_t index;
+    std::uint64_t payload;
+};
+
+struct SnapshotSource{
+    // Variables
+    std::uint64_t codeOffset;
+    std::uint64_t codeLength;
+};
+
+// Lists point at count values, upvalues at one, closures at count SnapshotBindings and name the
+// node of their lambda by source and node.
+struct SnapshotObject{
+    // Variables
+    std::uint32_t kind;
+    std::uint32_t count;
+    std::uint64_t itemsOffset;
+    std::uint32_t source;
+    std::uint32_t node;
+};
+
+struct SnapshotBinding{
+    // Variables
+    std::uint64_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t upvalue;
+};
+
+struct SnapshotVariable{
+    // Variables
+    std::uint64_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t reserved;
+    SnapshotValue value;
+};
+
+// Helper Functions
+// Saves every variable visible from the current scope, numbers, strings, lists, functions and
+// closures, with the sources their functions were parsed from. Returns the number of variables.
+std::size_t writeSnapshot(const std::string &path, ScopeManager &scope);
+
+// Defines the variables of a snapshot in the global scope, parsing its sources again so the
+// functions point into live trees. Returns the number of variables.
+std::size_t loadSnapshot(const std::string &path, ScopeManager &scope);
+
+#endif
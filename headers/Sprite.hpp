@@ -0,0 +1,36 @@
+#ifndef SPRITE_HPP
+#define SPRITE_HPP
+
+#include "Canvas.hpp"
+
+// A rectangle of a canvas. Sprites packed by an atlas all share the atlas canvas, so drawing many
+// of them reads from one buffer instead of one allocation per image.
+struct SpriteObject : public HeapObject{
+    // Variables
+    Ref image;
+    ClipRect region;
+
+    // Constructor & Destructor
+    SpriteObject(Ref image, const ClipRect &region);
+    ~SpriteObject() = default;
+
+    // Functions
+    std::size_t byteSize() const override;
+    CanvasObject &canvas() const{ return *image.as<CanvasObject>(); }
+    int width() const{ return region.x1 - region.x0; }
+    int height() const{ return region.y1 - region.y0; }
+};
+
+struct AtlasPlacement{
+    // Variables
+    int x, y;
+};
+
+// Shelf packing, tallest first, into a width close to the square root of the total area. Returns
+// the position of every size in input order and the atlas dimensions.
+std::vector<AtlasPlacement> packAtlas(const std::vector<std::pair<int, int>> &sizes, int &atlasWidth, int &atlasHeight);
+
+// Helper Functions
+SpriteObject *asSprite(const Data &data, const std::string &identifier);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+// Evaluator counters printed by --stats. They are compiled in only when the build defines
+// CANVAS_STATS (cmake -DCANVAS_STATS=ON), otherwise the macros below expand to nothing. Every
+// thread counts into its own EvalStats, so isolates never contend on a counter.
+// STATS_NODE_KINDS must stay above the last NodeType, AST.hpp checks it where the enum is defined.
+const std::size_t STATS_NODE_KINDS = 32;
+
+struct EvalStats{
+    // Variables
+    std::array<std::uint64_t, STATS_NODE_KINDS> nodes{};
+    std::uint64_t pushScope = 0;
+    std::uint64_t findData = 0;
+    std::uint64_t scopeHops = 0;
+    std::uint64_t stringCopies = 0;
+    std::uint64_t userCalls = 0;
+    std::unordered_map<std::string, std::uint64_t> builtins;
+};
+
+#ifdef CANVAS_STATS
+EvalStats &threadStats();
+
+#define CANVAS_STAT(counter) (++threadStats().counter)
+#define CANVAS_STAT_NODE(type) (++threadStats().nodes[static_cast<std::size_t>(type)])
+#define CANVAS_STAT_BUILTIN(name) (++threadStats().builtins[name])
+#define CANVAS_STAT_STRING(data) (std::holds_alternative<std::string>(data) ? ++threadStats().stringCopies : 0)
+#else
+#define CANVAS_STAT(counter) ((void)0)
+#define CANVAS_STAT_NODE(type) ((void)0)
+#define CANVAS_STAT_BUILTIN(name) ((void)0)
+#define CANVAS_STAT_STRING(data) ((void)0)
+#endif
+
+// Helper Functions
+bool isStatsEnabled();
+EvalStats collectStats();
+void writeStats(std::ostream &stream);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+
+// A fixed set of workers shared by everything that splits native work (rasterising, encoding...).
+// parallelFor can be called from several threads at once, the caller works on its own job too.
+class ThreadPool{
+    private:
+        struct Job;
+
+        // Variables
+        std::vector<std::thread> m_workers;
+        std::deque<std::shared_ptr<Job>> m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_isStopping = false;
+
+        // Functions
+        void work();
+        static void runJob(Job &job);
+    public:
+        // Variables
+        // Constructor & Destructor
+        ThreadPool(std::size_t threadCount);
+        ~ThreadPool();
+
+        // Functions
+        std::size_t size() const;
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &task);
+};
+
+// Helper Functions
+ThreadPool &sharedThreadPool();
+
+#endif
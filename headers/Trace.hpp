@@ -0,0 +1,95 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Records Chrome trace events for --trace: interpreter phases, imports, user function calls and
+// the regions scripts mark with trace_begin()/trace_end(). Every thread appends complete ("X")
+// events to its own buffer without locking; close() merges the buffers into one JSON file that
+// chrome://tracing and Perfetto open. Spans still open at close() end there.
+class Tracer{
+    private:
+        struct Span{
+            // Variables
+            std::string name;
+            const char *category;
+            double start;
+        };
+
+        struct Event{
+            // Variables
+            std::string name;
+            const char *category;
+            double start;
+            double duration;
+        };
+
+        struct ThreadBuffer{
+            // Variables
+            int tid;
+            std::string name;
+            std::vector<Event> events;
+            std::vector<Span> spans;
+            std::vector<Span> scriptSpans;
+        };
+
+        // Variables
+        std::atomic<bool> m_isEnabled{false};
+        std::string m_path;
+        std::chrono::steady_clock::time_point m_startTime;
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+        // Functions
+        ThreadBuffer &buffer();
+        double now() const;
+        void endSpan(ThreadBuffer &buffer, std::vector<Span> &spans, double end);
+    public:
+        // Variables
+        // Constructor & Destructor
+        Tracer() = default;
+        ~Tracer() = default;
+
+        Tracer(const Tracer&) = delete;
+        Tracer &operator=(const Tracer&) = delete;
+
+        // Functions
+        void open(const std::string &path);
+        bool isEnabled() const{
+            return m_isEnabled.load(std::memory_order_relaxed);
+        }
+        void nameThread(const std::string &name);
+
+        void begin(const std::string &name, const char *category);
+        void end();
+        void beginScript(const std::string &name);
+        bool endScript();
+        void endScripts();
+
+        void close();
+};
+
+// Traces the lifetime of the object as one span, when tracing is on.
+class TraceSpan{
+    private:
+        // Variables
+        bool m_isActive;
+    public:
+        // Variables
+        // Constructor & Destructor
+        TraceSpan(const std::string &name, const char *category);
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan &operator=(const TraceSpan&) = delete;
+};
+
+// Helper Functions
+Tracer &tracer();
+
+#endif
@@ -5,11 +5,12 @@
 #include <variant>
 #include <unordered_map>
 #include <unordered_set>
+#include <functional>
+#include <istream>
 
 #include "Regex.hpp"
 #include "ResManager.hpp"
-
-using Data = std::variant<void*, std::int32_t, float, std::string>;
+#include "Heap.hpp"
 
 // Interpreter Utililty
 enum class RET_CODE{
@@ -137,5 +138,9 @@ std::string stripStr(std::string str);
 std::string sanitizeStr(std::string str);
 
 std::string loadFileContentAsCode(std::string fileName);
+std::string loadSourceAsCode(std::istream &stream);
+
+void runWithStackSize(std::size_t stackBytes, const std::function<void()> &task);
+std::size_t nativeStackSizeFor(std::size_t maxCallDepth);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef VIDEO_HPP
+#define VIDEO_HPP
+
+#include "Image.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+// Frames in flight: one being copied in, the others queued or being encoded.
+const std::size_t FRAME_QUEUE_DEPTH = 3;
+
+// Writes a sequence of frames, either numbered images from a pattern such as "out/frame_%04d.png"
+// or a Y4M stream (4:2:0, BT.601 limited range, alpha ignored) to a file or to stdout ("-").
+//
+// submit() copies the canvas into one of FRAME_QUEUE_DEPTH preallocated slots and returns, a
+// dedicated thread encodes and writes the frames in order. The script renders frame k + 1 while
+// frame k is written and waits only when every slot is taken, so memory stays constant. Y4M keeps
+// the converted planes of the last frame and converts again only the tiles a frame changed.
+//
+// There is one sink per process and it belongs to the main script: isolates cannot open or close
+// it and their frames are not queued.
+class FrameSink{
+    private:
+        struct Slot{
+            // Variables
+            std::unique_ptr<CanvasObject> canvas;
+            std::vector<std::uint8_t> changed;
+            bool isIncremental = false;
+            std::size_t index = 0;
+        };
+
+        // Variables
+        std::string m_target;
+        std::string m_prefix;
+        std::string m_suffix;
+        int m_digits = 0;
+        ImageFormat m_format = ImageFormat::PNG;
+        bool m_isY4m = false;
+        int m_fps = 30;
+        int m_width = 0;
+        int m_height = 0;
+
+        std::vector<Slot> m_slots;
+        std::deque<Slot*> m_free;
+        std::deque<Slot*> m_ready;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_worker;
+        bool m_isOpen = false;
+        bool m_isClosing = false;
+        std::string m_error;
+        std::size_t m_submitted = 0;
+        std::size_t m_written = 0;
+
+        const CanvasObject *m_lastCanvas = nullptr;
+        std::size_t m_lastFrame = 0;
+
+        // Encoder thread only
+        std::unique_ptr<FileWriter> m_stream;
+        std::vector<std::uint8_t> m_planes;
+
+        // Functions
+        void work();
+        void encode(Slot &slot);
+        void encodeY4m(Slot &slot);
+        std::string framePath(std::size_t index) const;
+    public:
+        // Variables
+        // Constructor & Destructor
+        FrameSink() = default;
+        ~FrameSink();
+
+        FrameSink(const FrameSink&) = delete;
+        FrameSink &operator=(const FrameSink&) = delete;
+
+        // Functions
+        void open(const std::string &target, int fps);
+        bool isOpen() const;
+        void submit(CanvasObject &canvas);
+        std::size_t close();
+};
+
+// Helper Functions
+FrameSink &frameSink();
+
+#endif
@@ -0,0 +1,73 @@
+/* Runs scripts through headers/CanvasApi.h the way a C host does, prints "passed" when every check held. */
+#include "../headers/CanvasApi.h"
+#include <stdio.h>
+#include <string.h>
+
+static int fails = 0;
+
+static void expect(int isHeld, const char *what){
+    if(!isHeld){
+        printf("failed: %s\n", what);
+        ++fails;
+    }
+}
+
+static int twice(canvas_call *call, void *user_data){
+    (void)user_data;
+    if(canvas_arg_type(call, 0) != CANVAS_NUMBER){
+        canvas_call_error(call, "twice expects a number");
+        return -1;
+    }
+
+    canvas_return_number(call, canvas_arg_number(call, 0) * 2.0);
+    return 0;
+}
+
+static int run(canvas_interpreter *interpreter, canvas_scope *scope, const char *source){
+    canvas_program *program = canvas_compile(interpreter, source, strlen(source));
+    if(program == NULL){
+        return -1;
+    }
+
+    int result = canvas_run(interpreter, program, scope);
+    canvas_program_free(program);
+    return result;
+}
+
+int main(void){
+    canvas_interpreter *interpreter = canvas_interpreter_new();
+    canvas_scope *scope = canvas_scope_new(interpreter);
+    double number = 0.0;
+    canvas_string_view text;
+
+    expect(canvas_register_native(interpreter, "twice", twice, NULL) == 0, "registering a native");
+    expect(run(interpreter, scope, "x = twice(21); name = \"canvas\";") == 0, "running a program");
+    expect(canvas_get_number(scope, "x", &number) == 0 && number == 42.0, "a native's result");
+    expect(canvas_get_string(scope, "name", &text) == 0 && text.size == 6 && memcmp(text.data, "canvas", 6) == 0, "a string global");
+    expect(canvas_get_type(scope, "missing") == CANVAS_NONE, "a missing global");
+
+    /* Globals set by the host are seen by the next program run in the scope. */
+    expect(canvas_set_number(scope, "y", 2.5) == 0 && run(interpreter, scope, "z = y * 2;") == 0, "reading a host global");
+    expect(canvas_get_number(scope, "z", &number) == 0 && number == 5.0, "the scope keeping globals");
+
+    /* Numbers are 32-bit floats, colours are exact. */
+    canvas_set_number(scope, "big", 16777217.0);
+    expect(canvas_get_number(scope, "big", &number) == 0 && number == 16777216.0, "numbers rounded to floats");
+    expect(run(interpreter, scope, "colour = rgba(1, 2, 3, 0.5);") == 0, "making a colour");
+    expect(canvas_get_number(scope, "colour", &number) == 0 && number == (double)(int)0x80030201u, "colours read exactly");
+
+    /* Errors and limits leave the scope usable. */
+    expect(run(interpreter, scope, "twice(\"a\");") == -1 && strstr(canvas_last_error(interpreter), "twice expects a number") != NULL, "a native's error");
+    canvas_set_budget(interpreter, 1000, 0);
+    expect(run(interpreter, scope, "while(1){ }") == CANVAS_LIMIT_EXCEEDED, "the step limit");
+    canvas_set_budget(interpreter, 0, 0);
+    expect(run(interpreter, scope, "w = x + 1;") == 0 && canvas_get_number(scope, "w", &number) == 0 && number == 43.0, "running after an error");
+
+    canvas_scope_free(scope);
+    canvas_interpreter_free(interpreter);
+
+    if(fails == 0){
+        printf("passed\n");
+    }
+    return fails == 0 ? 0 : 1;
+}